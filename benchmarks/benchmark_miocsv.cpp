@@ -11,6 +11,23 @@
 
 #include <stdcsv.h>
 #include <miocsv.h>
+#include <columncsv.h>
+#include <arrowcsv.h>
+#include <cachecsv.h>
+#ifdef BGZF_INPUT_FILE
+#include <bgzfcsv.h>
+#endif
+
+#include <chrono>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
 
 void run_Reader()
 {
@@ -48,6 +65,500 @@ void run_MIODictReader()
     }
 }
 
+#ifdef BGZF_INPUT_FILE
+void run_BGZFReader(miocsv::size_type thread_num)
+{
+    auto reader = miocsv::BGZFReader {BGZF_INPUT_FILE, ',', thread_num};
+    for (const auto& line: reader)
+    {
+        // do nothing
+    }
+}
+#endif
+
+miocsv::size_type run_MIODictReader_lookup()
+{
+    miocsv::size_type n = 0;
+    auto reader = miocsv::MIODictReader {INPUT_FILE};
+    // headers of INPUT_FILE are quoted and quotes are kept
+    for (const auto& line: reader)
+    {
+        n += line["\"runid\""].size() + line["\"package\""].size() + line["\"timing\""].size()
+             + line["\"platform\""].size() + line["\"experiment_date\""].size();
+    }
+
+    return n;
+}
+
+miocsv::size_type run_MIODictReader_column()
+{
+    miocsv::size_type n = 0;
+    auto reader = miocsv::MIODictReader {INPUT_FILE};
+    auto runid = reader.column("\"runid\"");
+    auto package = reader.column("\"package\"");
+    auto timing = reader.column("\"timing\"");
+    auto platform = reader.column("\"platform\"");
+    auto experiment_date = reader.column("\"experiment_date\"");
+    for (const auto& line: reader)
+    {
+        n += line[runid].size() + line[package].size() + line[timing].size()
+             + line[platform].size() + line[experiment_date].size();
+    }
+
+    return n;
+}
+
+double run_MIODictReader_stod()
+{
+    double n = 0;
+    auto reader = miocsv::MIODictReader {INPUT_FILE};
+    for (const auto& line: reader)
+    {
+        n += std::stol(line[3]) + std::stol(line[4]) + std::stol(line[7]) + std::stod(line[8])
+             + std::stod(line[9]);
+    }
+
+    return n;
+}
+
+double run_MIODictReader_get()
+{
+    double n = 0;
+    auto reader = miocsv::MIODictReader {INPUT_FILE};
+    for (const auto& line: reader)
+    {
+        n += *line.get<long>(3) + *line.get<long>(4) + *line.get<long>(7) + *line.get<double>(8)
+             + *line.get<double>(9);
+    }
+
+    return n;
+}
+
+miocsv::size_type run_MIODictReader_to_columns()
+{
+    std::vector<long> rows, cols, samples;
+    std::vector<double> timings, bytes;
+
+    auto reader = miocsv::MIODictReader {INPUT_FILE};
+    for (const auto& line: reader)
+    {
+        rows.push_back(line.get<long>(3).value_or(0));
+        cols.push_back(line.get<long>(4).value_or(0));
+        samples.push_back(line.get<long>(7).value_or(0));
+        timings.push_back(line.get<double>(8).value_or(0));
+        bytes.push_back(line.get<double>(9).value_or(0));
+    }
+
+    return rows.size();
+}
+
+miocsv::size_type run_load_columns(miocsv::size_type thread_num)
+{
+    auto [rows, cols, samples, timings, bytes] =
+        miocsv::load_columns<long, long, long, double, double>(
+            INPUT_FILE, {"\"rows\"", "\"cols\"", "\"sample\"", "\"timing\"", "\"bytes\""}, ',',
+            thread_num);
+
+    return rows.size();
+}
+
+/**
+ * @brief load the numeric columns of INPUT_FILE with NaN taken as null
+ */
+miocsv::size_type run_load_nullable_columns()
+{
+    using miocsv::Nullable;
+
+    auto [rows, cols, samples, timings, bytes] =
+        miocsv::load_columns<long, long, long, Nullable<double>, Nullable<double>>(
+            INPUT_FILE, {"\"rows\"", "\"cols\"", "\"sample\"", "\"timing\"", "\"bytes\""}, ',', 0,
+            {"", "NA", "NaN"});
+
+    return bytes.validity.null_count();
+}
+
+/**
+ * @brief load all the columns of INPUT_FILE as per its inferred schema with string columns
+ *        in std::vector<std::string> or exported to the Arrow C data interface
+ */
+const miocsv::Schema& get_schema()
+{
+    static auto schema = [] {
+        auto s = miocsv::infer_schema(INPUT_FILE);
+        for (miocsv::size_type j = 0; j != s.size(); ++j)
+            s[j].encoded = false;
+
+        return s;
+    }();
+
+    return schema;
+}
+
+miocsv::size_type run_load_table()
+{
+    return miocsv::load_table(INPUT_FILE, get_schema()).row_num();
+}
+
+miocsv::size_type run_load_arrow()
+{
+    ArrowArray array;
+    ArrowSchema schema;
+    miocsv::load_arrow(INPUT_FILE, get_schema(), &array, &schema);
+
+    auto n = static_cast<miocsv::size_type>(array.length);
+    array.release(&array);
+    schema.release(&schema);
+    return n;
+}
+
+/**
+ * @brief open the cache of INPUT_FILE, which is built in the first iteration, and sum up a
+ *        numeric column from it
+ */
+double run_open_cache()
+{
+    auto cache = miocsv::open_cache(INPUT_FILE, get_schema());
+
+    double sum = 0;
+    for (auto v : cache.values<double>(8))
+        sum += v;
+
+    return sum;
+}
+
+/**
+ * @brief load the low-cardinality string columns of INPUT_FILE, i.e., runid, attempt, package,
+ *        and platform, as std::string or dictionary-encoded
+ */
+template<typename T>
+miocsv::size_type run_load_string_columns()
+{
+    auto [runids, attempts, packages, platforms] = miocsv::load_columns<T, T, T, T>(
+        INPUT_FILE, {"\"runid\"", "\"attempt\"", "\"package\"", "\"platform\""});
+
+    return runids.size();
+}
+
+/**
+ * @brief the fields of experiment_date in INPUT_FILE, e.g., 2020-05-02T06:13:38.426
+ */
+const std::vector<std::string>& get_datetime_fields()
+{
+    static std::vector<std::string> fields;
+    if (fields.empty())
+    {
+        auto reader = miocsv::MIODictReader {INPUT_FILE};
+        for (const auto& line: reader)
+            fields.push_back(line[11]);
+    }
+
+    return fields;
+}
+
+long long run_get_time()
+{
+    long long n = 0;
+    for (const auto& s : get_datetime_fields())
+    {
+        std::tm tm {};
+        int ms = 0;
+        std::istringstream iss {s};
+        iss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%S");
+        iss.ignore(1) >> ms;
+        auto t = std::chrono::sys_days {std::chrono::year {tm.tm_year + 1900} / (tm.tm_mon + 1) / tm.tm_mday}
+                 + std::chrono::hours {tm.tm_hour} + std::chrono::minutes {tm.tm_min}
+                 + std::chrono::seconds {tm.tm_sec} + std::chrono::milliseconds {ms};
+        n += t.time_since_epoch().count();
+    }
+
+    return n;
+}
+
+long long run_parse_datetime()
+{
+    long long n = 0;
+    for (const auto& s : get_datetime_fields())
+    {
+        std::chrono::sys_time<std::chrono::milliseconds> t;
+        miocsv::from_field(s, t);
+        n += t.time_since_epoch().count();
+    }
+
+    return n;
+}
+
+/**
+ * @brief the fields of timing and bytes in INPUT_FILE
+ */
+const std::vector<std::string>& get_numeric_fields()
+{
+    static std::vector<std::string> fields;
+    if (fields.empty())
+    {
+        auto reader = miocsv::MIODictReader {INPUT_FILE};
+        for (const auto& line: reader)
+        {
+            fields.push_back(line[8]);
+            fields.push_back(line[9]);
+        }
+    }
+
+    return fields;
+}
+
+double run_from_field()
+{
+    static std::vector<std::string_view> fields {get_numeric_fields().begin(),
+                                                 get_numeric_fields().end()};
+    static std::vector<double> values(fields.size());
+
+    for (miocsv::size_type i = 0; i != fields.size(); ++i)
+        miocsv::from_field(fields[i], values[i]);
+
+    return values.back();
+}
+
+double run_decode_column()
+{
+    static std::vector<std::string_view> fields {get_numeric_fields().begin(),
+                                                 get_numeric_fields().end()};
+    static std::vector<double> values;
+
+    miocsv::decode_column(fields, values);
+    return values.back();
+}
+
+// the number of rows written per iteration by the writer benchmarks
+constexpr miocsv::size_type WRITE_ROW_NUM = 200000;
+
+std::string get_output_path()
+{
+    return (std::filesystem::temp_directory_path() / "miocsv_output.csv").string();
+}
+
+/**
+ * @brief the baseline of writing rows via std::ofstream operator<< as Writer did
+ */
+void run_ofstream_write()
+{
+    std::ofstream ost {get_output_path()};
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        ost << i << ',' << "link" << ',' << i * 0.1 << ',' << i % 7 << ',' << 1.0 / (i + 1) << '\n';
+}
+
+void run_Writer_write_row_raw()
+{
+    auto writer = miocsv::Writer {get_output_path()};
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        writer.write_row_raw(i, "link", i * 0.1, i % 7, 1.0 / (i + 1));
+}
+
+void run_Writer_write_row()
+{
+    auto writer = miocsv::Writer {get_output_path()};
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        writer.write_row({i, "link", i * 0.1, i % 7, 1.0 / (i + 1)});
+}
+
+void run_AsyncWriter_write_row_raw()
+{
+    auto writer = miocsv::AsyncWriter {get_output_path()};
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        writer.write_row_raw(i, "link", i * 0.1, i % 7, 1.0 / (i + 1));
+}
+
+void run_MMapWriter_write_row_raw()
+{
+    auto writer = miocsv::MMapWriter {get_output_path()};
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        writer.write_row_raw(i, "link", i * 0.1, i % 7, 1.0 / (i + 1));
+}
+
+void run_write_rows_parallel(miocsv::size_type thread_num)
+{
+    static std::vector<miocsv::size_type> ids;
+    if (ids.empty())
+    {
+        for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+            ids.push_back(i);
+    }
+
+    miocsv::write_rows_parallel(get_output_path(), ids, [](miocsv::BaseWriter& w, miocsv::size_type i) {
+        w.write_row_raw(i, "link", i * 0.1, i % 7, 1.0 / (i + 1));
+    }, thread_num);
+}
+
+/**
+ * @brief thread_num producers sharing a Writer behind a mutex, or a ConcurrentWriter, with
+ *        WRITE_ROW_NUM rows in total
+ */
+template<typename W>
+void run_shared_writer(miocsv::size_type thread_num)
+{
+    auto writer = W {get_output_path()};
+    std::mutex mtx;
+
+    std::vector<std::thread> producers;
+    for (miocsv::size_type k = 0; k != thread_num; ++k)
+    {
+        producers.emplace_back([&, k]() {
+            for (auto i = k; i < WRITE_ROW_NUM; i += thread_num)
+            {
+                if constexpr (std::is_same_v<W, miocsv::Writer>)
+                {
+                    std::lock_guard<std::mutex> lk {mtx};
+                    writer.write_row_raw(i, "link", i * 0.1, i % 7, 1.0 / (i + 1));
+                }
+                else
+                {
+                    writer.write_row_raw(i, "link", i * 0.1, i % 7, 1.0 / (i + 1));
+                }
+            }
+        });
+    }
+
+    for (auto& p : producers)
+        p.join();
+}
+
+miocsv::size_type run_Row_from_values()
+{
+    miocsv::size_type n = 0;
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+    {
+        miocsv::Row r {i, "link", i * 0.1, i % 7, miocsv::with_precision(1.0 / (i + 1), 6)};
+        n += r.size();
+    }
+
+    return n;
+}
+
+/**
+ * @brief the columns of WRITE_ROW_NUM rows as a structure of arrays
+ */
+const auto& get_output_columns()
+{
+    static std::tuple<std::vector<miocsv::size_type>, std::vector<std::string>, std::vector<double>> cols;
+    auto& [ids, names, lengths] = cols;
+    if (ids.empty())
+    {
+        for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        {
+            ids.push_back(i);
+            names.push_back("link_" + std::to_string(i % 100));
+            lengths.push_back(i * 0.1);
+        }
+    }
+
+    return cols;
+}
+
+// the baseline of building a Row per row out of the columns
+void run_Writer_columns_by_row()
+{
+    const auto& [ids, names, lengths] = get_output_columns();
+    auto writer = miocsv::Writer {get_output_path()};
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        writer.write_row({ids[i], names[i], lengths[i]});
+}
+
+void run_Writer_write_columns()
+{
+    const auto& [ids, names, lengths] = get_output_columns();
+    auto writer = miocsv::Writer {get_output_path()};
+    writer.write_columns({"id", "name", "length"}, ids, names, lengths);
+}
+
+/**
+ * @brief the rows of INPUT_FILE including the quoted ones
+ */
+const std::vector<miocsv::Row>& get_rows()
+{
+    static std::vector<miocsv::Row> rows;
+    if (rows.empty())
+    {
+        auto reader = miocsv::MIOReader {INPUT_FILE};
+        for (const auto& line: reader)
+            rows.push_back(line);
+    }
+
+    return rows;
+}
+
+/**
+ * @brief write rows that are already built, where write_row() checks each record for quoting
+ */
+void run_Writer_rows(bool raw)
+{
+    auto writer = miocsv::Writer {get_output_path()};
+    for (const auto& r : get_rows())
+    {
+        if (raw)
+            writer.write_row_raw(r);
+        else
+            writer.write_row(r);
+    }
+}
+
+/**
+ * @brief split INPUT_FILE into small files with the same headers, 10 rows each
+ */
+const std::vector<std::string>& get_small_files()
+{
+    static constexpr miocsv::size_type FILE_NUM = 2000;
+    static constexpr miocsv::size_type ROW_NUM = 10;
+
+    static std::vector<std::string> paths;
+    if (!paths.empty())
+        return paths;
+
+    auto dir = std::filesystem::temp_directory_path() / "miocsv_small_files";
+    std::filesystem::create_directories(dir);
+
+    std::ifstream ist {INPUT_FILE};
+    std::string header;
+    std::getline(ist, header);
+
+    std::string s;
+    for (miocsv::size_type i = 0; i != FILE_NUM; ++i)
+    {
+        auto path = dir / ("zone-" + std::to_string(i) + ".csv");
+        std::ofstream ost {path};
+        ost << header << '\n';
+        for (miocsv::size_type j = 0; j != ROW_NUM && std::getline(ist, s); ++j)
+            ost << s << '\n';
+
+        paths.push_back(path.string());
+    }
+
+    return paths;
+}
+
+void run_MIODictReader_small_files()
+{
+    for (const auto& path : get_small_files())
+    {
+        auto reader = miocsv::MIODictReader {path};
+        for (const auto& line: reader)
+        {
+            // do nothing
+        }
+    }
+}
+
+void run_BatchDictReader_small_files()
+{
+    auto reader = miocsv::BatchDictReader {};
+    for (const auto& path : get_small_files())
+    {
+        reader.open(path);
+        for (const auto& line: reader)
+        {
+            // do nothing
+        }
+    }
+}
+
 void run_getline()
 {
     std::ifstream ist {INPUT_FILE};
@@ -81,6 +592,268 @@ static void BM_run_MIODictReader(benchmark::State& state)
         run_MIODictReader();
 }
 
+#ifdef BGZF_INPUT_FILE
+void run_BGZFWriter(miocsv::size_type thread_num)
+{
+    auto writer = miocsv::BGZFWriter {get_output_path() + ".gz", ',', thread_num};
+    for (miocsv::size_type i = 0; i != WRITE_ROW_NUM; ++i)
+        writer.write_row_raw(i, "link", i * 0.1, i % 7, 1.0 / (i + 1));
+}
+
+static void BM_run_BGZFWriter(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_BGZFWriter(state.range(0));
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_BGZFReader(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_BGZFReader(state.range(0));
+}
+#endif
+
+static void BM_run_MIODictReader_lookup(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_MIODictReader_lookup());
+}
+
+static void BM_run_MIODictReader_column(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_MIODictReader_column());
+}
+
+static void BM_run_MIODictReader_stod(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_MIODictReader_stod());
+}
+
+static void BM_run_MIODictReader_get(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_MIODictReader_get());
+}
+
+static void BM_run_MIODictReader_to_columns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_MIODictReader_to_columns());
+}
+
+static void BM_run_load_columns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_load_columns(state.range(0)));
+}
+
+static void BM_run_load_nullable_columns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_load_nullable_columns());
+}
+
+static void BM_run_load_table(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_load_table());
+}
+
+static void BM_run_load_arrow(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_load_arrow());
+}
+
+static void BM_run_open_cache(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_open_cache());
+
+    std::filesystem::remove(miocsv::cache_path(INPUT_FILE));
+}
+
+static void BM_run_load_string_columns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_load_string_columns<std::string>());
+}
+
+static void BM_run_load_encoded_columns(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_load_string_columns<miocsv::Dictionary>());
+}
+
+static void BM_run_get_time(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_get_time());
+
+    state.counters["fields"] = benchmark::Counter(
+        static_cast<double>(get_datetime_fields().size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_parse_datetime(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_parse_datetime());
+
+    state.counters["fields"] = benchmark::Counter(
+        static_cast<double>(get_datetime_fields().size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_from_field(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_from_field());
+
+    state.counters["fields"] = benchmark::Counter(
+        static_cast<double>(get_numeric_fields().size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_decode_column(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_decode_column());
+
+    state.counters["fields"] = benchmark::Counter(
+        static_cast<double>(get_numeric_fields().size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_ofstream_write(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_ofstream_write();
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_Writer_write_row_raw(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_Writer_write_row_raw();
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_AsyncWriter_write_row_raw(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_AsyncWriter_write_row_raw();
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_MMapWriter_write_row_raw(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_MMapWriter_write_row_raw();
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_write_rows_parallel(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_write_rows_parallel(state.range(0));
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_locked_Writer(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_shared_writer<miocsv::Writer>(state.range(0));
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_ConcurrentWriter(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_shared_writer<miocsv::ConcurrentWriter>(state.range(0));
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_Row_from_values(benchmark::State& state)
+{
+    for (auto _ : state)
+        benchmark::DoNotOptimize(run_Row_from_values());
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_Writer_columns_by_row(benchmark::State& state)
+{
+    get_output_columns();
+    for (auto _ : state)
+        run_Writer_columns_by_row();
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_Writer_write_columns(benchmark::State& state)
+{
+    get_output_columns();
+    for (auto _ : state)
+        run_Writer_write_columns();
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_Writer_write_row(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_Writer_write_row();
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(WRITE_ROW_NUM), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_Writer_rows(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_Writer_rows(state.range(0));
+
+    state.counters["rows"] = benchmark::Counter(
+        static_cast<double>(get_rows().size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_MIODictReader_small_files(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_MIODictReader_small_files();
+
+    state.counters["files"] = benchmark::Counter(
+        static_cast<double>(get_small_files().size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
+static void BM_run_BatchDictReader_small_files(benchmark::State& state)
+{
+    for (auto _ : state)
+        run_BatchDictReader_small_files();
+
+    state.counters["files"] = benchmark::Counter(
+        static_cast<double>(get_small_files().size()), benchmark::Counter::kIsIterationInvariantRate);
+}
+
 static void BM_run_getline(benchmark::State& state)
 {
     for (auto _ : state)
@@ -94,5 +867,39 @@ BENCHMARK(BM_run_MIOReader)->Iterations(ITERATION_NUM);
 BENCHMARK(BM_run_DictReader)->Iterations(ITERATION_NUM);
 BENCHMARK(BM_run_MIODictReader)->Iterations(ITERATION_NUM);
 BENCHMARK(BM_run_getline)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_MIODictReader_lookup)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_MIODictReader_column)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_MIODictReader_stod)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_MIODictReader_get)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_MIODictReader_to_columns)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_load_columns)->Iterations(ITERATION_NUM)->Arg(1)->Arg(4);
+BENCHMARK(BM_run_load_nullable_columns)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_load_table)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_load_arrow)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_open_cache)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_load_string_columns)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_load_encoded_columns)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_get_time)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_parse_datetime)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_from_field)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_decode_column)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_ofstream_write)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_Writer_write_row_raw)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_AsyncWriter_write_row_raw)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_MMapWriter_write_row_raw)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_write_rows_parallel)->Iterations(ITERATION_NUM)->Arg(1)->Arg(4);
+BENCHMARK(BM_run_locked_Writer)->Iterations(ITERATION_NUM)->Arg(4)->UseRealTime();
+BENCHMARK(BM_run_ConcurrentWriter)->Iterations(ITERATION_NUM)->Arg(4)->UseRealTime();
+BENCHMARK(BM_run_Row_from_values)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_Writer_write_row)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_Writer_columns_by_row)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_Writer_write_columns)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_Writer_rows)->Iterations(ITERATION_NUM)->Arg(0)->Arg(1);
+BENCHMARK(BM_run_MIODictReader_small_files)->Iterations(ITERATION_NUM);
+BENCHMARK(BM_run_BatchDictReader_small_files)->Iterations(ITERATION_NUM);
+#ifdef BGZF_INPUT_FILE
+BENCHMARK(BM_run_BGZFReader)->Iterations(ITERATION_NUM)->Arg(1)->Arg(2)->Arg(4)->Arg(8);
+BENCHMARK(BM_run_BGZFWriter)->Iterations(ITERATION_NUM)->Arg(1)->Arg(4)->UseRealTime();
+#endif
 
 BENCHMARK_MAIN();
\ No newline at end of file
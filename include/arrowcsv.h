@@ -0,0 +1,296 @@
+/**
+ * @file arrowcsv.h, part of the project MIOCSV under Apache License 2.0
+ * @author jdlph (jdlph@hotmail.com)
+ * @brief Load csv files into the Apache Arrow C data interface with no Arrow dependency
+ *
+ * @copyright Copyright (c) 2022 - 2024 Peiheng Li, Ph.D.
+ *
+ */
+
+#ifndef GUARD_ARROWCSV_H
+#define GUARD_ARROWCSV_H
+
+#include "columncsv.h"
+
+#include <cstdint>
+#include <memory>
+
+// the stable C ABI as specified by https://arrow.apache.org/docs/format/CDataInterface.html,
+// which is guarded in the same way as arrow/c/abi.h so that either one can come first
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+struct ArrowSchema {
+    // array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // release callback
+    void (*release)(struct ArrowSchema*);
+    // opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // release callback
+    void (*release)(struct ArrowArray*);
+    // opaque producer-specific data
+    void* private_data;
+};
+}
+
+#endif // ARROW_C_DATA_INTERFACE
+
+namespace miocsv
+{
+namespace detail
+{
+/**
+ * @brief the table and the buffers converted for Arrow, which are shared by an exported
+ *        array and all its children so that any of them can be moved out and outlive the rest
+ */
+struct ArrowBuffers {
+    Table table;
+    // Boolean columns packed into bits
+    std::vector<std::vector<std::uint8_t>> bits;
+    // Date columns narrowed to date32
+    std::vector<std::vector<std::int32_t>> days;
+    // std::vector<std::string> columns and the values of dictionaries
+    std::vector<StringColumn> strings;
+};
+
+struct ArrowArrayData {
+    std::shared_ptr<ArrowBuffers> owner;
+    std::vector<const void*> buffers;
+    std::vector<ArrowArray*> children;
+    ArrowArray* dictionary = nullptr;
+};
+
+struct ArrowSchemaData {
+    std::string format;
+    std::string name;
+    std::vector<ArrowSchema*> children;
+    ArrowSchema* dictionary = nullptr;
+};
+
+// release a child or a dictionary unless it has been moved out by the consumer
+template<typename T>
+void release_child(T* child)
+{
+    if (child->release)
+        child->release(child);
+
+    delete child;
+}
+
+inline void release_array(ArrowArray* array)
+{
+    auto* data = static_cast<ArrowArrayData*>(array->private_data);
+    for (auto* child : data->children)
+        release_child(child);
+
+    if (data->dictionary)
+        release_child(data->dictionary);
+
+    delete data;
+    array->release = nullptr;
+}
+
+inline void release_schema(ArrowSchema* schema)
+{
+    auto* data = static_cast<ArrowSchemaData*>(schema->private_data);
+    for (auto* child : data->children)
+        release_child(child);
+
+    if (data->dictionary)
+        release_child(data->dictionary);
+
+    delete data;
+    schema->release = nullptr;
+}
+
+inline ArrowArrayData* fill_array(ArrowArray* array, std::shared_ptr<ArrowBuffers> owner, size_type length,
+                                  size_type null_count, std::vector<const void*> buffers)
+{
+    auto* data = new ArrowArrayData {std::move(owner), std::move(buffers), {}, nullptr};
+    *array = {static_cast<int64_t>(length), static_cast<int64_t>(null_count), 0,
+              static_cast<int64_t>(data->buffers.size()), 0, data->buffers.data(), nullptr,
+              nullptr, release_array, data};
+
+    return data;
+}
+
+inline ArrowSchemaData* fill_schema(ArrowSchema* schema, std::string format, std::string name,
+                                    int64_t flags)
+{
+    auto* data = new ArrowSchemaData {std::move(format), std::move(name), {}, nullptr};
+    *schema = {data->format.c_str(), data->name.c_str(), nullptr, flags, 0, nullptr, nullptr,
+               release_schema, data};
+
+    return data;
+}
+
+/**
+ * @brief describe column j of the table owned by owner as a child array and its schema
+ */
+inline void export_column(const std::shared_ptr<ArrowBuffers>& owner, size_type j, ArrowArray* array,
+                          ArrowSchema* schema)
+{
+    const auto& validity = owner->table.validity[j];
+    auto length = validity.size();
+    auto null_count = validity.null_count();
+    const void* nulls = null_count ? validity.data() : nullptr;
+
+    std::string name {unquote(owner->table.schema[j].name)};
+    auto export_strings = [&](const StringColumn& col) {
+        fill_array(array, owner, length, null_count, {nulls, col.offsets.data(), col.data.data()});
+        fill_schema(schema, "U", name, ARROW_FLAG_NULLABLE);
+    };
+
+    std::visit([&](auto& col) {
+        using C = std::decay_t<decltype(col)>;
+        if constexpr (std::is_same_v<C, std::vector<std::int64_t>>)
+        {
+            fill_array(array, owner, length, null_count, {nulls, col.data()});
+            fill_schema(schema, "l", name, ARROW_FLAG_NULLABLE);
+        }
+        else if constexpr (std::is_same_v<C, std::vector<double>>)
+        {
+            fill_array(array, owner, length, null_count, {nulls, col.data()});
+            fill_schema(schema, "g", name, ARROW_FLAG_NULLABLE);
+        }
+        else if constexpr (std::is_same_v<C, std::vector<char>>)
+        {
+            auto& bits = owner->bits.emplace_back((length + 7) / 8, 0);
+            for (size_type i = 0; i != length; ++i)
+                bits[i >> 3] |= static_cast<std::uint8_t>((col[i] != 0) << (i & 7));
+
+            fill_array(array, owner, length, null_count, {nulls, bits.data()});
+            fill_schema(schema, "b", name, ARROW_FLAG_NULLABLE);
+        }
+        else if constexpr (std::is_same_v<C, std::vector<std::chrono::sys_days>>)
+        {
+            auto& days = owner->days.emplace_back(length);
+            for (size_type i = 0; i != length; ++i)
+                days[i] = static_cast<std::int32_t>(col[i].time_since_epoch().count());
+
+            fill_array(array, owner, length, null_count, {nulls, days.data()});
+            fill_schema(schema, "tdD", name, ARROW_FLAG_NULLABLE);
+        }
+        else if constexpr (std::is_same_v<C, std::vector<Timestamp>>)
+        {
+            // Timestamp has the same representation as int64
+            fill_array(array, owner, length, null_count, {nulls, col.data()});
+            fill_schema(schema, "tsu:", name, ARROW_FLAG_NULLABLE);
+        }
+        else if constexpr (std::is_same_v<C, std::vector<std::string>>)
+        {
+            export_strings(owner->strings.emplace_back(pack_strings(col)));
+        }
+        else if constexpr (std::is_same_v<C, StringColumn>)
+        {
+            export_strings(col);
+        }
+        else
+        {
+            // the indices plus the distinct values as a dictionary
+            std::vector<std::string> values;
+            for (Dictionary::code_type c = 0; c != col.dictionary.size(); ++c)
+                values.push_back(col.dictionary[c]);
+
+            const auto& dict = owner->strings.emplace_back(pack_strings(values));
+
+            auto* data = fill_array(array, owner, length, null_count, {nulls, col.codes.data()});
+            data->dictionary = new ArrowArray;
+            fill_array(data->dictionary, owner, dict.size(), 0,
+                       {nullptr, dict.offsets.data(), dict.data.data()});
+            array->dictionary = data->dictionary;
+
+            // codes are exported as int32 indices as recommended by the spec, which is
+            // lossless for dictionaries of fewer than 2^31 values
+            auto* schema_data = fill_schema(schema, "i", name, ARROW_FLAG_NULLABLE);
+            schema_data->dictionary = new ArrowSchema;
+            fill_schema(schema_data->dictionary, "U", "", 0);
+            schema->dictionary = schema_data->dictionary;
+        }
+    }, owner->table.columns[j]);
+}
+} // namespace detail
+
+/**
+ * @brief export a table through the Arrow C data interface as a struct array (i.e., a record
+ *        batch) along with its schema
+ *
+ * @details the table is moved into the array, whose buffers are the columns as they are, i.e.,
+ *          no copy, except that Boolean columns are packed into bits, Date columns are
+ *          narrowed to date32, and std::vector<std::string> columns are packed into large
+ *          strings. encoded columns go to dictionary-encoded arrays with int32 indices, and
+ *          column names are unquoted.
+ *
+ * @note the consumer takes the ownership of both array and schema, and shall call their
+ *       release callbacks once done with them.
+ */
+inline void export_table(Table&& table, ArrowArray* array, ArrowSchema* schema)
+{
+    auto owner = std::make_shared<detail::ArrowBuffers>();
+    owner->table = std::move(table);
+
+    auto n = owner->table.columns.size();
+    auto* data = detail::fill_array(array, owner, owner->table.row_num(), 0, {nullptr});
+    auto* schema_data = detail::fill_schema(schema, "+s", "", 0);
+    for (size_type j = 0; j != n; ++j)
+    {
+        data->children.push_back(new ArrowArray);
+        schema_data->children.push_back(new ArrowSchema);
+        detail::export_column(owner, j, data->children.back(), schema_data->children.back());
+    }
+
+    array->n_children = static_cast<int64_t>(n);
+    array->children = data->children.data();
+    schema->n_children = static_cast<int64_t>(n);
+    schema->children = schema_data->children.data();
+}
+
+/**
+ * @brief load a csv file with headers as per a schema straight into the Arrow C data
+ *        interface, e.g.,
+ *
+ *  ArrowArray array;
+ *  ArrowSchema schema;
+ *  load_arrow("link.csv", infer_schema("link.csv"), &array, &schema);
+ *  auto batch = arrow::ImportRecordBatch(&array, &schema);
+ *
+ * @details the columns are built in parallel from the memory mapped file via load_table(),
+ *          where String columns not encoded are packed into offsets and data as Arrow does,
+ *          and then exported via export_table() with no further copy.
+ */
+inline void load_arrow(const std::string& path, const Schema& schema, ArrowArray* out_array,
+                       ArrowSchema* out_schema, const char delim = ',', size_type thread_num = 0,
+                       const NullTokens& nulls = {})
+{
+    export_table(load_table(path, schema, delim, thread_num, nulls, true), out_array, out_schema);
+}
+
+} // namespace miocsv
+
+#endif
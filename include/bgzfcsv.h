@@ -0,0 +1,690 @@
+/**
+ * @file bgzfcsv.h, part of the project MIOCSV under Apache License 2.0
+ * @author jdlph (jdlph@hotmail.com)
+ * @brief CSV parsers over BGZF-compressed files with parallel block decompression
+ *
+ * @copyright Copyright (c) 2022 - 2024 Peiheng Li, Ph.D.
+ *
+ */
+
+#ifndef GUARD_BGZFCSV_H
+#define GUARD_BGZFCSV_H
+
+#include "miocsv.h"
+
+#include <zlib.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <thread>
+
+namespace miocsv
+{
+/**
+ * @brief a BGZF block located in the memory mapped compressed file
+ *
+ * BGZF (blocked GNU Zip format) is a series of independent gzip members, each of which
+ * carries its own compressed size in the extra field "BC" and holds no more than 64KB
+ * of uncompressed data. it is still a standard gzip stream (i.e., gunzip works on it),
+ * but every block can be located without decompressing its predecessors.
+ */
+struct BGZFBlock {
+    // offset of the raw deflate data
+    size_type offset;
+    // size of the raw deflate data
+    size_type csize;
+    // size of the uncompressed data
+    size_type isize;
+    std::uint32_t crc;
+};
+
+class BGZFReader : public BaseMIOReader {
+public:
+    BGZFReader() = delete;
+
+    /**
+     * @param ms_ the path of a BGZF-compressed csv file (e.g., the output of bgzip)
+     * @param delim_ a single character delimiter
+     * @param thread_num_ the number of threads decompressing blocks. zero means all the
+     * hardware threads.
+     */
+    BGZFReader(const std::string& ms_, const char delim_ = ',', size_type thread_num_ = 0)
+        : BaseReader{}, BaseMIOReader{delim_}, ms {ms_}
+    {
+        setup(ms_, thread_num_);
+    }
+
+    BGZFReader(std::string&& ms_, const char delim_ = ',', size_type thread_num_ = 0)
+        : BaseReader{}, BaseMIOReader{delim_}, ms {ms_}
+    {
+        setup(ms_, thread_num_);
+    }
+
+    ~BGZFReader()
+    {
+        // the prefetching task reads from ms
+        if (next.valid())
+            next.wait();
+
+        ms.unmap();
+    }
+
+protected:
+    mio::mmap_source ms;
+
+private:
+    using Buffer = std::vector<char>;
+
+    // the number of blocks decompressed by each thread in one window (about 1MB)
+    static constexpr size_type BLOCKS_PER_THREAD = 16;
+
+    std::vector<BGZFBlock> blocks;
+    // index of the first block of the next window
+    size_type block_pos = 0;
+    size_type thread_num;
+
+    // the decompressed window being parsed and the one being prefetched
+    Buffer curr;
+    std::future<Buffer> next;
+
+    // a row straddling two windows is stitched together from carry and the next window
+    std::string carry;
+    std::string stitch;
+    // complete rows of curr that are left after the stitched row is parsed
+    const char* pending = nullptr;
+    const char* pending_end = nullptr;
+
+    void setup(const std::string& ms_, size_type thread_num_);
+
+    /**
+     * @brief make the next range of complete rows available to parse()
+     *
+     * @return true if there are rows left; false if EOF is reached.
+     */
+    bool refill() override;
+
+    // launch decompressing the next window asynchronously
+    void prefetch();
+
+    Buffer inflate_blocks(size_type first, size_type last) const;
+};
+
+void BGZFReader::setup(const std::string& ms_, size_type thread_num_)
+{
+    if (!ms.is_mapped())
+    {
+        std::cerr << ms_ << "is not successfully mapped!\n";
+        std::terminate();
+    }
+
+    thread_num = thread_num_ ? thread_num_ : std::thread::hardware_concurrency();
+    if (!thread_num)
+        thread_num = 1;
+
+    // index all the blocks by walking through their headers, which is cheap
+    const auto* p = reinterpret_cast<const unsigned char*>(ms.data());
+    for (size_type i = 0, sz = ms.size(); i != sz;)
+    {
+        // 12 bytes of the fixed gzip header, FLG must have FEXTRA set
+        if (sz - i < 18 || p[i] != 31 || p[i + 1] != 139 || p[i + 2] != 8 || !(p[i + 3] & 4))
+        {
+            std::cerr << ms_ << " is not BGZF-compressed!\n";
+            std::terminate();
+        }
+
+        size_type xlen = p[i + 10] | p[i + 11] << 8;
+        size_type bsize = 0;
+        // look for the subfield "BC"
+        for (size_type j = i + 12, j_end = std::min(j + xlen, sz); j + 4 <= j_end;)
+        {
+            size_type slen = p[j + 2] | p[j + 3] << 8;
+            if (p[j] == 'B' && p[j + 1] == 'C' && slen == 2 && j + 6 <= j_end)
+                bsize = (p[j + 4] | p[j + 5] << 8) + 1;
+
+            j += 4 + slen;
+        }
+
+        if (!bsize || bsize < 12 + xlen + 8 || bsize > sz - i)
+        {
+            std::cerr << ms_ << " is not BGZF-compressed!\n";
+            std::terminate();
+        }
+
+        const auto* t = p + i + bsize - 8;
+        std::uint32_t crc = t[0] | t[1] << 8 | t[2] << 16 | static_cast<std::uint32_t>(t[3]) << 24;
+        std::uint32_t isize = t[4] | t[5] << 8 | t[6] << 16 | static_cast<std::uint32_t>(t[7]) << 24;
+
+        // skip empty blocks, e.g., the EOF marker
+        if (isize)
+            blocks.push_back({i + 12 + xlen, bsize - 12 - xlen - 8, isize, crc});
+
+        i += bsize;
+    }
+
+    prefetch();
+}
+
+void BGZFReader::prefetch()
+{
+    if (block_pos == blocks.size())
+        return;
+
+    auto first = block_pos;
+    block_pos = std::min(blocks.size(), first + thread_num * BLOCKS_PER_THREAD);
+    next = std::async(std::launch::async, &BGZFReader::inflate_blocks, this, first, block_pos);
+}
+
+BGZFReader::Buffer BGZFReader::inflate_blocks(size_type first, size_type last) const
+{
+    // the prefix sums of the uncompressed sizes tell where each block goes
+    std::vector<size_type> offsets {0};
+    for (auto i = first; i != last; ++i)
+        offsets.push_back(offsets.back() + blocks[i].isize);
+
+    Buffer buf(offsets.back());
+    std::atomic<bool> corrupted {false};
+
+    auto worker = [&](size_type b, size_type e) {
+        z_stream zs {};
+        if (inflateInit2(&zs, -15) != Z_OK)
+        {
+            corrupted = true;
+            return;
+        }
+
+        for (auto i = b; i != e && !corrupted; ++i)
+        {
+            const auto& blk = blocks[i];
+            auto* dst = buf.data() + offsets[i - first];
+
+            inflateReset(&zs);
+            zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(ms.data() + blk.offset));
+            zs.avail_in = static_cast<uInt>(blk.csize);
+            zs.next_out = reinterpret_cast<Bytef*>(dst);
+            zs.avail_out = static_cast<uInt>(blk.isize);
+
+            if (inflate(&zs, Z_FINISH) != Z_STREAM_END || zs.total_out != blk.isize
+                || crc32(0, reinterpret_cast<const Bytef*>(dst), zs.total_out) != blk.crc)
+                corrupted = true;
+        }
+
+        inflateEnd(&zs);
+    };
+
+    auto n = last - first;
+    auto m = std::min(thread_num, n);
+    std::vector<std::thread> workers;
+    for (size_type k = 1; k < m; ++k)
+        workers.emplace_back(worker, first + n * k / m, first + n * (k + 1) / m);
+
+    // the calling thread takes the first share
+    worker(first, first + n / m);
+    for (auto& w : workers)
+        w.join();
+
+    if (corrupted)
+    {
+        std::cerr << "corrupted BGZF block found in [" << first << ", " << last << ")!\n";
+        std::terminate();
+    }
+
+    return buf;
+}
+
+bool BGZFReader::refill()
+{
+    if (pending != pending_end)
+    {
+        it = pending;
+        it_end = pending_end;
+        pending = pending_end = nullptr;
+        return true;
+    }
+
+    while (next.valid())
+    {
+        auto buf = next.get();
+        prefetch();
+
+        const char* b = buf.data();
+        const char* e = b + buf.size();
+        const char* first = std::find(b, e, LF);
+        if (first == e)
+        {
+            // the whole window belongs to a single row
+            carry.append(b, e);
+            continue;
+        }
+
+        const char* last = e;
+        while (*(last - 1) != LF)
+            --last;
+
+        curr = std::move(buf);
+        if (carry.empty())
+        {
+            it = b;
+            it_end = last;
+        }
+        else
+        {
+            // resynchronize the row boundary across two windows
+            stitch = std::move(carry);
+            stitch.append(b, ++first);
+
+            it = stitch.data();
+            it_end = it + stitch.size();
+            pending = first;
+            pending_end = last;
+        }
+
+        carry.assign(last, e);
+        return true;
+    }
+
+    // the last row without line ending
+    if (!carry.empty())
+    {
+        stitch = std::move(carry);
+        carry.clear();
+
+        it = stitch.data();
+        it_end = it + stitch.size();
+        return true;
+    }
+
+    return false;
+}
+
+class BGZFDictReader : public BGZFReader, public BaseDictReader {
+public:
+    BGZFDictReader() = delete;
+
+    BGZFDictReader(const std::string& ist_, const Row& fieldnames_ = {}, const char delim_ = ',',
+                   size_type thread_num_ = 0)
+        : BGZFReader{ist_, delim_, thread_num_}, BaseDictReader{}
+    {
+        setup_headers(fieldnames_);
+    }
+
+    BGZFDictReader(std::string&& ist_, const Row& fieldnames_ = {}, const char delim_ = ',',
+                   size_type thread_num_ = 0)
+        : BGZFReader{ist_, delim_, thread_num_}, BaseDictReader{}
+    {
+        setup_headers(fieldnames_);
+    }
+
+private:
+    bool iterate() override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!BGZFReader::iterate())
+                return false;
+        } while (row.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(row, &fns, row_num);
+
+        return true;
+    }
+
+    bool iterate_view(RowView& rv) override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!BGZFReader::iterate_view(rv))
+                return false;
+        } while (rv.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(rv, &fns, row_num);
+
+        return true;
+    }
+};
+
+/**
+ * @brief a writer compressing its output into BGZF, e.g., to archive large outputs
+ *        without piping them through gzip or bgzip
+ *
+ * @details the output is cut into independent blocks of up to BLOCK_SIZE, which are
+ *          compressed by a pool of worker threads in parallel as pigz does. a full buffer is
+ *          compressed and written by the workers while the next one is being filled. the
+ *          file is a standard gzip stream (i.e., gunzip works on it) ending with the EOF
+ *          marker of BGZF, and can be read back by BGZFReader in parallel.
+ *
+ * @note a failure on writing is rethrown as std::runtime_error by the next call handing
+ *       over a buffer, flush(), or close(), which is also called by the destructor, and the
+ *       output from then on is dropped.
+ */
+class BGZFWriter : public BaseWriter {
+public:
+    BGZFWriter() = delete;
+
+    /**
+     * @param ost_ the path of the output file, e.g., "link.csv.gz"
+     * @param delim_ a single character delimiter
+     * @param thread_num_ the number of threads compressing blocks. zero means all the
+     * hardware threads.
+     * @param level_ the compression level of zlib from 0 (no compression) to 9
+     */
+    BGZFWriter(const std::string& ost_, const char delim_ = ',', size_type thread_num_ = 0,
+               int level_ = Z_DEFAULT_COMPRESSION)
+        : BaseWriter{delim_}, path {ost_}, level {level_}
+    {
+        setup(thread_num_);
+    }
+
+    BGZFWriter(std::string&& ost_, const char delim_ = ',', size_type thread_num_ = 0,
+               int level_ = Z_DEFAULT_COMPRESSION)
+        : BaseWriter{delim_}, path {std::move(ost_)}, level {level_}
+    {
+        setup(thread_num_);
+    }
+
+    // the workers refer to this
+    BGZFWriter(const BGZFWriter&) = delete;
+    BGZFWriter& operator=(const BGZFWriter&) = delete;
+
+    BGZFWriter(BGZFWriter&&) = delete;
+    BGZFWriter& operator=(BGZFWriter&&) = delete;
+
+    ~BGZFWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+        }
+    }
+
+    /**
+     * @brief hand over the buffered output and wait until it is all written out
+     */
+    void flush() override;
+
+    /**
+     * @brief compress and write out the buffered output, stop the workers, append the EOF
+     *        marker, and close the file
+     *
+     * @note nothing can be written after it.
+     */
+    void close();
+
+private:
+    // the max size of uncompressed data per block as bgzip takes
+    static constexpr size_type BLOCK_SIZE = 0xff00;
+    // the max size of a compressed block including its header and footer
+    static constexpr size_type MAX_BLOCK_SIZE = 0x10000;
+    static constexpr size_type HEADER_SIZE = 18;
+    static constexpr size_type FOOTER_SIZE = 8;
+
+    std::string path;
+    std::ofstream ost;
+    size_type thread_num;
+    int level;
+
+    // the buffer being compressed and written by the workers
+    std::string pending;
+    // the output of the current job, i.e., pending
+    const char* src = nullptr;
+    size_type src_size = 0;
+    // the compressed blocks of src and their sizes
+    std::vector<unsigned char> blocks;
+    std::vector<size_type> sizes;
+    size_type block_num = 0;
+    // the next block of src to be taken by a worker
+    std::atomic<size_type> block_pos {0};
+
+    // a job is compressing and writing src, which every worker takes part in
+    std::size_t job_id = 0;
+    // the number of workers done with the current job
+    size_type reported = 0;
+    bool busy = false;
+    bool stopped = false;
+    bool failed = false;
+
+    std::mutex mtx;
+    // wake the workers up for a job or stopping
+    std::condition_variable job_cv;
+    // wake the calling thread up once a job is done
+    std::condition_variable done_cv;
+    std::vector<std::thread> workers;
+
+    void setup(size_type thread_num_);
+
+    // the loop of a worker
+    void run();
+
+    // wait until the current job is done
+    void wait();
+
+    void check_failure() const
+    {
+        if (failed)
+            throw std::runtime_error{"BGZFWriter: failed to write to " + path};
+    }
+
+    void hand_over() override;
+
+    // start compressing and writing out [p, p + n), which shall stay valid until wait()
+    void write_out(const char* p, size_type n) override;
+
+    /**
+     * @brief compress [p, p + n) into a BGZF block at dst
+     *
+     * @return the size of the block
+     */
+    size_type deflate_block(z_stream& zs, const char* p, size_type n, unsigned char* dst) const;
+};
+
+void BGZFWriter::setup(size_type thread_num_)
+{
+    ost.rdbuf()->pubsetbuf(nullptr, 0);
+    ost.open(path, std::ios::binary);
+    if (!ost)
+    {
+        std::cerr << "invalid input! no " << path << '\n';
+        std::terminate();
+    }
+
+    thread_num = thread_num_ ? thread_num_ : std::thread::hardware_concurrency();
+    if (!thread_num)
+        thread_num = 1;
+
+    pending.reserve(BUFFER_SIZE);
+    for (size_type k = 0; k != thread_num; ++k)
+        workers.emplace_back(&BGZFWriter::run, this);
+}
+
+void BGZFWriter::flush()
+{
+    BaseWriter::flush();
+    wait();
+    check_failure();
+}
+
+void BGZFWriter::close()
+{
+    if (!ost.is_open())
+        return;
+
+    std::exception_ptr failure;
+    try
+    {
+        flush();
+    }
+    catch (...)
+    {
+        failure = std::current_exception();
+        buf.clear();
+    }
+
+    {
+        std::lock_guard<std::mutex> lk {mtx};
+        stopped = true;
+    }
+
+    job_cv.notify_all();
+    for (auto& w : workers)
+        w.join();
+
+    workers.clear();
+    if (!failure)
+    {
+        // the empty block marking the end of file
+        static constexpr unsigned char eof[] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0,
+                                                27, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        ost.write(reinterpret_cast<const char*>(eof), sizeof(eof));
+    }
+
+    bool ok = static_cast<bool>(ost);
+    ost.close();
+    if (failure)
+        std::rethrow_exception(failure);
+
+    if (!ok)
+        throw std::runtime_error{"BGZFWriter: failed to write to " + path};
+}
+
+void BGZFWriter::wait()
+{
+    std::unique_lock<std::mutex> lk {mtx};
+    done_cv.wait(lk, [this] { return !busy; });
+}
+
+void BGZFWriter::hand_over()
+{
+    // pending shall be done with before it is taken again
+    wait();
+    if (failed)
+    {
+        buf.clear();
+        check_failure();
+    }
+
+    buf.swap(pending);
+    buf.clear();
+    write_out(pending.data(), pending.size());
+}
+
+void BGZFWriter::write_out(const char* p, size_type n)
+{
+    // the workers are idle here
+    src = p;
+    src_size = n;
+    block_num = (n + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    if (blocks.size() < block_num * MAX_BLOCK_SIZE)
+        blocks.resize(block_num * MAX_BLOCK_SIZE);
+
+    sizes.resize(block_num);
+    block_pos = 0;
+
+    {
+        std::lock_guard<std::mutex> lk {mtx};
+        reported = 0;
+        busy = true;
+        ++job_id;
+    }
+
+    job_cv.notify_all();
+}
+
+void BGZFWriter::run()
+{
+    z_stream zs {};
+    if (deflateInit2(&zs, level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        std::cerr << "failed to initialize zlib for " << path << "!\n";
+        std::terminate();
+    }
+
+    std::size_t seen = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lk {mtx};
+            job_cv.wait(lk, [&] { return stopped || job_id != seen; });
+            if (job_id == seen)
+                break;
+
+            seen = job_id;
+        }
+
+        for (auto i = block_pos++; i < block_num; i = block_pos++)
+        {
+            auto offset = i * BLOCK_SIZE;
+            sizes[i] = deflate_block(zs, src + offset, std::min(BLOCK_SIZE, src_size - offset),
+                                     blocks.data() + i * MAX_BLOCK_SIZE);
+        }
+
+        {
+            std::lock_guard<std::mutex> lk {mtx};
+            if (++reported != thread_num)
+                continue;
+        }
+
+        // the last worker done writes all the blocks out in order
+        for (size_type i = 0; i != block_num; ++i)
+            ost.write(reinterpret_cast<const char*>(blocks.data() + i * MAX_BLOCK_SIZE), sizes[i]);
+
+        {
+            std::lock_guard<std::mutex> lk {mtx};
+            failed |= !ost;
+            busy = false;
+        }
+
+        done_cv.notify_all();
+    }
+
+    deflateEnd(&zs);
+}
+
+size_type BGZFWriter::deflate_block(z_stream& zs, const char* p, size_type n, unsigned char* dst) const
+{
+    // fall back to storing the data as it is if it is incompressible and does not fit in
+    for (auto lvl : {level, 0})
+    {
+        deflateReset(&zs);
+        deflateParams(&zs, lvl, Z_DEFAULT_STRATEGY);
+
+        zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(p));
+        zs.avail_in = static_cast<uInt>(n);
+        zs.next_out = dst + HEADER_SIZE;
+        zs.avail_out = static_cast<uInt>(MAX_BLOCK_SIZE - HEADER_SIZE - FOOTER_SIZE);
+        if (deflate(&zs, Z_FINISH) != Z_STREAM_END)
+            continue;
+
+        auto bsize = HEADER_SIZE + zs.total_out + FOOTER_SIZE;
+        const unsigned char header[] = {31, 139, 8, 4, 0, 0, 0, 0, 0, 255, 6, 0, 'B', 'C', 2, 0,
+                                        static_cast<unsigned char>((bsize - 1) & 0xFF),
+                                        static_cast<unsigned char>((bsize - 1) >> 8)};
+        std::memcpy(dst, header, HEADER_SIZE);
+
+        auto* t = dst + HEADER_SIZE + zs.total_out;
+        auto crc = crc32(0, reinterpret_cast<const Bytef*>(p), static_cast<uInt>(n));
+        for (auto i = 0; i != 4; ++i)
+        {
+            t[i] = static_cast<unsigned char>(crc >> (8 * i));
+            t[i + 4] = static_cast<unsigned char>(n >> (8 * i));
+        }
+
+        return bsize;
+    }
+
+    std::cerr << "failed to compress a block for " << path << "!\n";
+    std::terminate();
+}
+
+} // namespace miocsv
+
+#endif
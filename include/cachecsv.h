@@ -0,0 +1,636 @@
+/**
+ * @file cachecsv.h, part of the project MIOCSV under Apache License 2.0
+ * @author jdlph (jdlph@hotmail.com)
+ * @brief Cache parsed csv files as memory mappable binary columnar files for fast restarts
+ *
+ * @copyright Copyright (c) 2022 - 2024 Peiheng Li, Ph.D.
+ *
+ */
+
+#ifndef GUARD_CACHECSV_H
+#define GUARD_CACHECSV_H
+
+#include "columncsv.h"
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <stdexcept>
+
+namespace miocsv
+{
+namespace detail
+{
+/**
+ * @brief the layout of a cache file, i.e., CacheHeader, CacheColumn per column, and then
+ *        the names and the buffers, each of which starts at a multiple of CACHE_ALIGNMENT
+ *
+ * @details all the integers are in the native byte order, which is checked via byte_order.
+ */
+inline constexpr char CACHE_MAGIC[8] = {'M', 'I', 'O', 'C', 'A', 'C', 'H', 'E'};
+inline constexpr std::uint32_t CACHE_VERSION = 1;
+inline constexpr std::uint32_t CACHE_BYTE_ORDER = 0x01020304;
+inline constexpr size_type CACHE_ALIGNMENT = 64;
+
+struct CacheHeader {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t byte_order;
+    // the stamp of the source, see SourceStamp
+    std::uint64_t source_size;
+    std::int64_t source_mtime;
+    std::uint64_t source_hash;
+    // the hash of the delimiter and the null tokens
+    std::uint64_t options_hash;
+    std::uint64_t row_num;
+    std::uint64_t column_num;
+};
+
+struct CacheBuffer {
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+/**
+ * @brief a column in the cache, where buffers are the validity bitmap followed by
+ *
+ *  std::vector<T>: the values;
+ *  std::vector<std::string> and StringColumn: the offsets and the data as StringColumn;
+ *  EncodedColumn: the codes, and the offsets and the data of the dictionary.
+ */
+struct CacheColumn {
+    // the index of the alternative in ColumnVector
+    std::uint32_t kind;
+    // ColumnType
+    std::uint32_t type;
+    std::uint32_t encoded;
+    std::uint32_t reserved;
+    CacheBuffer name;
+    CacheBuffer buffers[4];
+};
+
+/**
+ * @brief what tells if a source has changed since its cache was written, i.e., its size,
+ *        its last write time, and a hash of its first and last 64KB
+ *
+ * @details hashing the whole file would cost as much as a good share of parsing it.
+ */
+struct SourceStamp {
+    std::uint64_t size;
+    std::int64_t mtime;
+    std::uint64_t hash;
+};
+
+// FNV-1a
+inline std::uint64_t hash_bytes(const char* p, size_type n, std::uint64_t h = 14695981039346656037ull)
+{
+    for (size_type i = 0; i != n; ++i)
+    {
+        h ^= static_cast<unsigned char>(p[i]);
+        h *= 1099511628211ull;
+    }
+
+    return h;
+}
+
+inline SourceStamp stamp_source(const std::string& path)
+{
+    // the portion hashed at both ends
+    static constexpr size_type HASHED_SIZE = 1 << 16;
+
+    SourceStamp stamp {};
+    stamp.size = std::filesystem::file_size(path);
+    stamp.mtime = std::filesystem::last_write_time(path).time_since_epoch().count();
+
+    std::ifstream ifs {path, std::ios::binary};
+    std::string buf(std::min<size_type>(stamp.size, HASHED_SIZE), '\0');
+    ifs.read(buf.data(), static_cast<std::streamsize>(buf.size()));
+    stamp.hash = hash_bytes(buf.data(), buf.size());
+
+    if (stamp.size > HASHED_SIZE)
+    {
+        auto n = std::min<size_type>(stamp.size - HASHED_SIZE, HASHED_SIZE);
+        ifs.seekg(static_cast<std::streamoff>(stamp.size - n));
+        ifs.read(buf.data(), static_cast<std::streamsize>(n));
+        stamp.hash = hash_bytes(buf.data(), n, stamp.hash);
+    }
+
+    return stamp;
+}
+
+inline std::uint64_t hash_options(const char delim, const NullTokens& nulls)
+{
+    auto h = hash_bytes(&delim, 1);
+    for (const auto& s : nulls.get_tokens())
+    {
+        // the size separates tokens
+        auto n = s.size();
+        h = hash_bytes(reinterpret_cast<const char*>(&n), sizeof(n), h);
+        h = hash_bytes(s.data(), n, h);
+    }
+
+    return h;
+}
+
+/**
+ * @brief append buffers to a cache file from offset on with their offsets aligned
+ */
+class CacheWriter {
+public:
+    CacheWriter(std::ofstream& ofs_, size_type offset_) : ofs {ofs_}, offset {offset_}
+    {
+        ofs.seekp(static_cast<std::streamoff>(offset));
+    }
+
+    template<typename T>
+    CacheBuffer add(const T* p, size_type n)
+    {
+        static constexpr char PADDING[CACHE_ALIGNMENT] = {};
+
+        auto size = n * sizeof(T);
+        auto aligned = (offset + CACHE_ALIGNMENT - 1) / CACHE_ALIGNMENT * CACHE_ALIGNMENT;
+        ofs.write(PADDING, static_cast<std::streamsize>(aligned - offset));
+        ofs.write(reinterpret_cast<const char*>(p), static_cast<std::streamsize>(size));
+
+        offset = aligned + size;
+        return {aligned, size};
+    }
+
+private:
+    std::ofstream& ofs;
+    size_type offset;
+};
+} // namespace detail
+
+// the cache file of a csv file
+inline std::string cache_path(const std::string& path)
+{
+    return path + ".miocache";
+}
+
+/**
+ * @brief write a table loaded from a csv file into its cache file (i.e., cache_path(path))
+ *
+ * @details the cache is written to a temporary file first and then renamed so that a
+ *          reader never sees a partial one.
+ *
+ * @param stamp the stamp of the source taken before the table is loaded, so that a change
+ *        during loading leaves the cache stale rather than taken as fresh
+ * @param delim, nulls the options the table is loaded with
+ * @return false if the cache cannot be written, where no cache file is left behind.
+ */
+inline bool write_cache(const Table& table, const std::string& path, const detail::SourceStamp& stamp,
+                        const char delim = ',', const NullTokens& nulls = {})
+{
+    detail::CacheHeader header {};
+    std::memcpy(header.magic, detail::CACHE_MAGIC, sizeof(header.magic));
+    header.version = detail::CACHE_VERSION;
+    header.byte_order = detail::CACHE_BYTE_ORDER;
+    header.source_size = stamp.size;
+    header.source_mtime = stamp.mtime;
+    header.source_hash = stamp.hash;
+    header.options_hash = detail::hash_options(delim, nulls);
+    header.row_num = table.row_num();
+    header.column_num = table.columns.size();
+
+    auto dst = cache_path(path);
+    auto tmp = dst + ".tmp";
+    std::ofstream ofs {tmp, std::ios::binary | std::ios::trunc};
+
+    // the buffers go first and the header and the columns last as the latter know the former
+    std::vector<detail::CacheColumn> descs(table.columns.size());
+    detail::CacheWriter writer {ofs, sizeof(header) + descs.size() * sizeof(detail::CacheColumn)};
+    for (size_type j = 0; j != table.columns.size(); ++j)
+    {
+        auto& desc = descs[j];
+        const auto& c = table.schema[j];
+        desc.kind = static_cast<std::uint32_t>(table.columns[j].index());
+        desc.type = static_cast<std::uint32_t>(c.type);
+        desc.encoded = c.encoded;
+        desc.name = writer.add(c.name.data(), c.name.size());
+
+        const auto& validity = table.validity[j];
+        desc.buffers[0] = writer.add(validity.data(), (validity.size() + 7) / 8);
+
+        auto add_strings = [&](const StringColumn& col, size_type k) {
+            desc.buffers[k] = writer.add(col.offsets.data(), col.offsets.size());
+            desc.buffers[k + 1] = writer.add(col.data.data(), col.data.size());
+        };
+
+        std::visit([&](const auto& col) {
+            using C = std::decay_t<decltype(col)>;
+            if constexpr (std::is_same_v<C, std::vector<std::string>>)
+            {
+                add_strings(detail::pack_strings(col), 1);
+            }
+            else if constexpr (std::is_same_v<C, StringColumn>)
+            {
+                add_strings(col, 1);
+            }
+            else if constexpr (std::is_same_v<C, EncodedColumn>)
+            {
+                desc.buffers[1] = writer.add(col.codes.data(), col.codes.size());
+
+                std::vector<std::string> values;
+                for (Dictionary::code_type k = 0; k != col.dictionary.size(); ++k)
+                    values.push_back(col.dictionary[k]);
+
+                add_strings(detail::pack_strings(values), 2);
+            }
+            else
+            {
+                desc.buffers[1] = writer.add(col.data(), col.size());
+            }
+        }, table.columns[j]);
+    }
+
+    ofs.seekp(0);
+    ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    ofs.write(reinterpret_cast<const char*>(descs.data()),
+              static_cast<std::streamsize>(descs.size() * sizeof(detail::CacheColumn)));
+    ofs.close();
+
+    std::error_code ec;
+    if (ofs)
+        std::filesystem::rename(tmp, dst, ec);
+
+    if (!ofs || ec)
+    {
+        std::cerr << "CAUTION: " << dst << " cannot be written!\n";
+        std::filesystem::remove(tmp, ec);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief write a table into the cache of path as above, where the source is stamped now
+ *
+ * @note the source shall not have changed since the table is loaded.
+ */
+inline bool write_cache(const Table& table, const std::string& path, const char delim = ',',
+                        const NullTokens& nulls = {})
+{
+    return write_cache(table, path, detail::stamp_source(path), delim, nulls);
+}
+
+/**
+ * @brief a memory mapped cache file, whose columns are served as views with no copy
+ */
+class CachedTable {
+public:
+    /**
+     * @brief a view of a column of strings in the cache, i.e., StringColumn as it is mapped
+     */
+    class Strings {
+    public:
+        Strings(std::span<const StringColumn::offset_type> offsets_, const char* data_)
+            : offsets {offsets_}, data {data_}
+        {
+        }
+
+        size_type size() const
+        {
+            return offsets.empty() ? 0 : offsets.size() - 1;
+        }
+
+        std::string_view operator[](size_type i) const
+        {
+            return {data + offsets[i], static_cast<size_type>(offsets[i + 1] - offsets[i])};
+        }
+
+    private:
+        std::span<const StringColumn::offset_type> offsets;
+        const char* data;
+    };
+
+    CachedTable() = delete;
+
+    explicit CachedTable(const std::string& cache_path_) : ms {cache_path_}
+    {
+        if (!validate())
+        {
+            std::cerr << cache_path_ << " is not a valid cache file!\n";
+            std::terminate();
+        }
+    }
+
+    /**
+     * @brief map a cache file only if it is valid, i.e., written by this version on a machine
+     *        of the same byte order and with every buffer within the file
+     *
+     * @return std::nullopt if it is missing or invalid.
+     */
+    static std::optional<CachedTable> try_open(const std::string& cache_path_)
+    {
+        std::error_code ec;
+        mio::mmap_source ms_;
+        ms_.map(cache_path_, ec);
+        if (ec)
+            return std::nullopt;
+
+        CachedTable cache {std::move(ms_)};
+        if (!cache.validate())
+            return std::nullopt;
+
+        return cache;
+    }
+
+    /**
+     * @brief if it is up to date with the source file and agrees with a schema and the options
+     *        of loading
+     */
+    bool matches(const std::string& path, const Schema& schema, const char delim = ',',
+                 const NullTokens& nulls = {}) const
+    {
+        auto stamp = detail::stamp_source(path);
+        if (stamp.size != header.source_size || stamp.mtime != header.source_mtime
+            || stamp.hash != header.source_hash || detail::hash_options(delim, nulls) != header.options_hash
+            || schema.size() != descs.size())
+            return false;
+
+        for (size_type j = 0; j != descs.size(); ++j)
+        {
+            if (get_name(j) != schema[j].name || descs[j].type != static_cast<std::uint32_t>(schema[j].type)
+                || static_cast<bool>(descs[j].encoded) != schema[j].encoded)
+                return false;
+        }
+
+        return true;
+    }
+
+    size_type row_num() const
+    {
+        return header.row_num;
+    }
+
+    // the number of columns
+    size_type size() const
+    {
+        return descs.size();
+    }
+
+    std::string_view get_name(size_type j) const
+    {
+        return {ms.data() + descs[j].name.offset, descs[j].name.size};
+    }
+
+    bool is_null(size_type j, size_type i) const
+    {
+        auto* bits = reinterpret_cast<const std::uint8_t*>(ms.data() + descs[j].buffers[0].offset);
+        return !(bits[i >> 3] >> (i & 7) & 1);
+    }
+
+    /**
+     * @brief the values of column j, where T is the type of elements of its std::vector
+     *        alternative in ColumnVector (e.g., double for Float), or Dictionary::code_type
+     *        for the codes of an encoded column
+     *
+     * @note std::bad_variant_access will be thrown if T does not match the column.
+     */
+    template<typename T>
+    std::span<const T> values(size_type j) const
+    {
+        const auto& desc = descs.at(j);
+        bool matched = false;
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            ((matched |= desc.kind == I && is_values_of<T, std::variant_alternative_t<I, ColumnVector>>()), ...);
+        }(std::make_index_sequence<std::variant_size_v<ColumnVector>>{});
+
+        if (!matched)
+            throw std::bad_variant_access{};
+
+        return view<T>(desc.buffers[1]);
+    }
+
+    /**
+     * @brief the strings of column j, i.e., its values if it is a column of strings or the
+     *        distinct values if it is an encoded one
+     *
+     * @note std::bad_variant_access will be thrown if the column holds no strings.
+     */
+    Strings strings(size_type j) const
+    {
+        const auto& desc = descs.at(j);
+        auto k = kind_of<EncodedColumn>() == desc.kind ? 2 : 1;
+        if (k == 1 && desc.kind != kind_of<StringColumn>() && desc.kind != kind_of<std::vector<std::string>>())
+            throw std::bad_variant_access{};
+
+        return {view<StringColumn::offset_type>(desc.buffers[k]), ms.data() + desc.buffers[k + 1].offset};
+    }
+
+    /**
+     * @brief copy the cache into a Table as load_table() gives with the same schema
+     */
+    Table to_table(const Schema& schema) const
+    {
+        Table table {schema, std::vector<ColumnVector>(descs.size()),
+                     std::vector<ValidityBitmap>(descs.size())};
+
+        for (size_type j = 0; j != descs.size(); ++j)
+        {
+            const auto& desc = descs[j];
+            table.validity[j].assign(view<std::uint8_t>(desc.buffers[0]).data(), row_num());
+
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                ((desc.kind == I ? (table.columns[j] = to_column<std::variant_alternative_t<I, ColumnVector>>(j), 0) : 0), ...);
+            }(std::make_index_sequence<std::variant_size_v<ColumnVector>>{});
+        }
+
+        return table;
+    }
+
+private:
+    mio::mmap_source ms;
+    detail::CacheHeader header {};
+    std::vector<detail::CacheColumn> descs;
+
+    explicit CachedTable(mio::mmap_source&& ms_) : ms {std::move(ms_)}
+    {
+    }
+
+    /**
+     * @brief read the header and the columns, and check them against the size of the file
+     *
+     * @details the contents of the buffers (e.g., the offsets of strings and the codes) are
+     *          trusted, which would cost a scan of the whole file otherwise.
+     */
+    bool validate()
+    {
+        if (!ms.is_mapped() || ms.size() < sizeof(header))
+            return false;
+
+        std::memcpy(&header, ms.data(), sizeof(header));
+        if (std::memcmp(header.magic, detail::CACHE_MAGIC, sizeof(header.magic))
+            || header.version != detail::CACHE_VERSION || header.byte_order != detail::CACHE_BYTE_ORDER
+            || header.column_num > (ms.size() - sizeof(header)) / sizeof(detail::CacheColumn))
+            return false;
+
+        descs.resize(header.column_num);
+        std::memcpy(descs.data(), ms.data() + sizeof(header), descs.size() * sizeof(detail::CacheColumn));
+
+        for (const auto& desc : descs)
+        {
+            auto bitmap_size = header.row_num / 8 + (header.row_num % 8 != 0);
+            if (!in_bounds(desc.name) || !in_bounds(desc.buffers[0]) || desc.buffers[0].size != bitmap_size)
+                return false;
+
+            bool valid = false;
+            [&]<std::size_t... I>(std::index_sequence<I...>) {
+                ((desc.kind == I ? (valid = validate<std::variant_alternative_t<I, ColumnVector>>(desc), 0) : 0), ...);
+            }(std::make_index_sequence<std::variant_size_v<ColumnVector>>{});
+
+            if (!valid)
+                return false;
+        }
+
+        return true;
+    }
+
+    // the buffers of a column of type C
+    template<typename C>
+    bool validate(const detail::CacheColumn& desc) const
+    {
+        if constexpr (std::is_same_v<C, std::vector<std::string>> || std::is_same_v<C, StringColumn>)
+            return validate_strings(desc, 1, header.row_num + 1);
+        else if constexpr (std::is_same_v<C, EncodedColumn>)
+        {
+            return has_elements<Dictionary::code_type>(desc.buffers[1], header.row_num)
+                   && validate_strings(desc, 2, 0);
+        }
+        else
+            return has_elements<typename C::value_type>(desc.buffers[1], header.row_num);
+    }
+
+    // the offsets and the data of strings at buffers k and k + 1, where n is the number of
+    // offsets or 0 if it is unknown
+    bool validate_strings(const detail::CacheColumn& desc, size_type k, size_type n) const
+    {
+        const auto& offsets = desc.buffers[k];
+        const auto& data = desc.buffers[k + 1];
+        if (!in_bounds(offsets) || !in_bounds(data) || offsets.size % sizeof(StringColumn::offset_type)
+            || (n && offsets.size / sizeof(StringColumn::offset_type) != n))
+            return false;
+
+        auto v = view<StringColumn::offset_type>(offsets);
+        return v.empty() || (v.front() == 0 && v.back() >= 0 && static_cast<size_type>(v.back()) <= data.size);
+    }
+
+    template<typename T>
+    bool has_elements(const detail::CacheBuffer& buf, size_type n) const
+    {
+        return in_bounds(buf) && buf.size % sizeof(T) == 0 && buf.size / sizeof(T) == n;
+    }
+
+    // within the file and aligned as written by write_cache()
+    bool in_bounds(const detail::CacheBuffer& buf) const
+    {
+        return buf.offset % detail::CACHE_ALIGNMENT == 0 && buf.offset <= ms.size()
+               && buf.size <= ms.size() - buf.offset;
+    }
+
+    // the index of C in ColumnVector
+    template<typename C, std::size_t I = 0>
+    static constexpr std::uint32_t kind_of()
+    {
+        if constexpr (std::is_same_v<std::variant_alternative_t<I, ColumnVector>, C>)
+            return I;
+        else
+            return kind_of<C, I + 1>();
+    }
+
+    template<typename T, typename C>
+    static constexpr bool is_values_of()
+    {
+        if constexpr (std::is_same_v<C, EncodedColumn>)
+            return std::is_same_v<T, Dictionary::code_type>;
+        else if constexpr (std::is_same_v<C, StringColumn> || std::is_same_v<C, std::vector<std::string>>)
+            return false;
+        else
+            return std::is_same_v<T, typename C::value_type>;
+    }
+
+    template<typename T>
+    std::span<const T> view(const detail::CacheBuffer& buf) const
+    {
+        return {reinterpret_cast<const T*>(ms.data() + buf.offset), buf.size / sizeof(T)};
+    }
+
+    template<typename C>
+    C to_column(size_type j) const
+    {
+        if constexpr (std::is_same_v<C, std::vector<std::string>>)
+        {
+            auto strs = strings(j);
+            C col;
+            col.reserve(strs.size());
+            for (size_type i = 0; i != strs.size(); ++i)
+                col.emplace_back(strs[i]);
+
+            return col;
+        }
+        else if constexpr (std::is_same_v<C, StringColumn>)
+        {
+            const auto& desc = descs[j];
+            auto offsets = view<StringColumn::offset_type>(desc.buffers[1]);
+            auto data = view<char>(desc.buffers[2]);
+            return {{offsets.begin(), offsets.end()}, {data.begin(), data.end()}};
+        }
+        else if constexpr (std::is_same_v<C, EncodedColumn>)
+        {
+            // the codes stay valid as the values are encoded in the order of their codes
+            auto strs = strings(j);
+            C col;
+            for (size_type i = 0; i != strs.size(); ++i)
+                col.dictionary.encode(strs[i]);
+
+            auto codes = values<Dictionary::code_type>(j);
+            col.codes.assign(codes.begin(), codes.end());
+            return col;
+        }
+        else
+        {
+            auto vals = view<typename C::value_type>(descs[j].buffers[1]);
+            return {vals.begin(), vals.end()};
+        }
+    }
+};
+
+/**
+ * @brief map the cache of a csv file loaded as per a schema, where the cache is (re)built
+ *        first via load_table() and write_cache() if it is missing or stale, e.g.,
+ *
+ *  auto cache = open_cache("link.csv", infer_schema("link.csv"));
+ *  auto caps = cache.values<double>(2);
+ *
+ * @details it is opt-in, i.e., load_table() never looks for a cache. the source is taken as
+ *          unchanged if its size, its last write time, and the hash of its both ends agree
+ *          with the cache.
+ *
+ * @note std::runtime_error will be thrown if the cache cannot be (re)built, e.g., in a
+ *       read-only directory, where load_table() is the way to go.
+ */
+inline CachedTable open_cache(const std::string& path, const Schema& schema, const char delim = ',',
+                              size_type thread_num = 0, const NullTokens& nulls = {})
+{
+    auto cpath = cache_path(path);
+    if (auto cache = CachedTable::try_open(cpath); cache && cache->matches(path, schema, delim, nulls))
+        return std::move(*cache);
+
+    // stamped before loading as the source might change in between
+    auto stamp = detail::stamp_source(path);
+    if (write_cache(load_table(path, schema, delim, thread_num, nulls, true), path, stamp, delim, nulls))
+    {
+        if (auto cache = CachedTable::try_open(cpath))
+            return std::move(*cache);
+    }
+
+    throw std::runtime_error{"open_cache: failed to cache " + path + " to " + cpath};
+}
+
+} // namespace miocsv
+
+#endif
@@ -0,0 +1,1123 @@
+/**
+ * @file columncsv.h, part of the project MIOCSV under Apache License 2.0
+ * @author jdlph (jdlph@hotmail.com)
+ * @brief Load csv files column by column into typed vectors (i.e., structure of arrays)
+ *
+ * @copyright Copyright (c) 2022 - 2024 Peiheng Li, Ph.D.
+ *
+ */
+
+#ifndef GUARD_COLUMNCSV_H
+#define GUARD_COLUMNCSV_H
+
+#include "miocsv.h"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <span>
+#include <tuple>
+#include <variant>
+
+namespace miocsv
+{
+/**
+ * @brief a dictionary-encoded column, i.e., one code per row plus each distinct value once
+ */
+struct EncodedColumn {
+    Dictionary dictionary;
+    std::vector<Dictionary::code_type> codes;
+
+    size_type size() const
+    {
+        return codes.size();
+    }
+
+    // the value of row i
+    const std::string& operator[](size_type i) const
+    {
+        return dictionary[codes[i]];
+    }
+};
+
+/**
+ * @brief a column of strings packed into one buffer, i.e., the value of row i is
+ *        data[offsets[i], offsets[i + 1]) with offsets[0] = 0
+ *
+ * @details it is the layout of the large string array of Apache Arrow.
+ */
+struct StringColumn {
+    using offset_type = std::int64_t;
+
+    std::vector<offset_type> offsets;
+    std::vector<char> data;
+
+    size_type size() const
+    {
+        return offsets.empty() ? 0 : offsets.size() - 1;
+    }
+
+    std::string_view operator[](size_type i) const
+    {
+        return {data.data() + offsets[i], static_cast<size_type>(offsets[i + 1] - offsets[i])};
+    }
+};
+
+/**
+ * @brief a packed bitmap telling which rows of a column are valid (i.e., non-null)
+ *
+ * @details it follows the validity bitmap of Apache Arrow, i.e., one bit per row in
+ *          least-significant bit order with 1 for valid, and the padding bits are clear.
+ */
+class ValidityBitmap {
+public:
+    // n rows, all of which are either valid or null
+    void assign(size_type n, bool valid = true)
+    {
+        bits.assign((n + 7) / 8, valid ? 0xFF : 0);
+        if (valid && n % 8)
+            bits.back() = static_cast<std::uint8_t>((1u << n % 8) - 1);
+
+        sz = n;
+    }
+
+    // n rows as per the packed bits from p
+    void assign(const std::uint8_t* p, size_type n)
+    {
+        bits.assign(p, p + (n + 7) / 8);
+        sz = n;
+    }
+
+    size_type size() const
+    {
+        return sz;
+    }
+
+    bool operator[](size_type i) const
+    {
+        return bits[i >> 3] >> (i & 7) & 1;
+    }
+
+    void set(size_type i, bool valid)
+    {
+        auto mask = static_cast<std::uint8_t>(1u << (i & 7));
+        if (valid)
+            bits[i >> 3] |= mask;
+        else
+            bits[i >> 3] &= ~mask;
+    }
+
+    // mark row i as null, which is safe to call concurrently for distinct rows
+    void set_null(size_type i)
+    {
+        auto mask = static_cast<std::uint8_t>(~(1u << (i & 7)));
+        std::atomic_ref<std::uint8_t> {bits[i >> 3]}.fetch_and(mask, std::memory_order_relaxed);
+    }
+
+    size_type null_count() const
+    {
+        size_type n = 0;
+        for (auto b : bits)
+            n += std::popcount(b);
+
+        return sz - n;
+    }
+
+    const std::uint8_t* data() const
+    {
+        return bits.data();
+    }
+
+private:
+    std::vector<std::uint8_t> bits;
+    size_type sz = 0;
+};
+
+/**
+ * @brief the tag of a nullable column in load_columns(), e.g., Nullable<double>
+ */
+template<typename T>
+struct Nullable {};
+
+/**
+ * @brief a column along with its validity bitmap, where a null is value-initialized
+ *
+ * @tparam C std::vector<T> or EncodedColumn
+ */
+template<typename C>
+struct NullableColumn {
+    C values;
+    ValidityBitmap validity;
+
+    size_type size() const
+    {
+        return values.size();
+    }
+
+    bool is_null(size_type i) const
+    {
+        return !validity[i];
+    }
+};
+
+namespace detail
+{
+// the column type of T in load_columns(), where Dictionary asks for EncodedColumn and
+// std::string_view for StringColumn
+template<typename T>
+struct column_of {
+    using type = std::vector<T>;
+};
+
+template<>
+struct column_of<Dictionary> {
+    using type = EncodedColumn;
+};
+
+template<>
+struct column_of<std::string_view> {
+    using type = StringColumn;
+};
+
+template<typename T>
+struct column_of<Nullable<T>> {
+    using type = NullableColumn<typename column_of<T>::type>;
+};
+
+template<typename T>
+using column_of_t = typename column_of<T>::type;
+
+// the values of a column exclusive of its validity bitmap
+template<typename C>
+C& values_of(C& col)
+{
+    return col;
+}
+
+template<typename C>
+C& values_of(NullableColumn<C>& col)
+{
+    return col.values;
+}
+
+template<typename C>
+ValidityBitmap* validity_of(C&)
+{
+    return nullptr;
+}
+
+template<typename C>
+ValidityBitmap* validity_of(NullableColumn<C>& col)
+{
+    return &col.validity;
+}
+
+/**
+ * @brief a csv file with headers whose rows are split into chunks to be parsed in parallel
+ */
+class ColumnSource : public MIODictReader {
+public:
+    ColumnSource(const std::string& ist_, const char delim_)
+        : BaseReader{}, MIODictReader{ist_, {}, delim_}
+    {
+    }
+
+    char get_delim() const
+    {
+        return delim;
+    }
+
+    // the rows after the headers
+    std::string_view body() const
+    {
+        return {it, static_cast<size_type>(it_end - it)};
+    }
+
+    /**
+     * @brief split the rows after the headers into at most n ranges at line endings
+     */
+    std::vector<std::string_view> split(size_type n) const
+    {
+        // a chunk shall be large enough to pay off its scheduling
+        static constexpr size_type MIN_CHUNK_SIZE = 1 << 16;
+
+        auto sz = static_cast<size_type>(it_end - it);
+        n = std::max<size_type>(1, std::min(n, sz / MIN_CHUNK_SIZE));
+
+        std::vector<std::string_view> chunks;
+        for (const char* b = it; b != it_end;)
+        {
+            auto* e = b + std::min(sz / n, static_cast<size_type>(it_end - b));
+            e = e == it_end ? e : std::find(e, it_end, LF);
+            e = e == it_end ? e : e + 1;
+
+            chunks.emplace_back(b, static_cast<size_type>(e - b));
+            b = e;
+        }
+
+        return chunks;
+    }
+};
+
+/**
+ * @brief parse a range of complete rows into views
+ */
+class ChunkReader : public BufferReader {
+public:
+    ChunkReader(std::string_view sv_, const char delim_)
+        : BaseReader{}, BufferReader{sv_, delim_}
+    {
+    }
+
+    // no exception to terminate
+    bool next(RowView& rv)
+    {
+        if (it == it_end)
+            return false;
+
+        rv.clear();
+        parse(rv);
+        ++row_num;
+        return true;
+    }
+
+    size_type count_rows() const
+    {
+        auto n = static_cast<size_type>(std::count(it, it_end, LF));
+        // the last row without line ending
+        if (it != it_end && *(it_end - 1) != LF)
+            ++n;
+
+        return n;
+    }
+};
+
+/**
+ * @brief convert the fields of rows from row_pos on into values of type T
+ *
+ * @details nulls are value-initialized and marked in validity if any.
+ *
+ * @return the number of non-null fields that cannot be converted, which are set to T{} too.
+ */
+template<typename T>
+size_type decode_fields(std::span<const std::string_view> fields, T* values, const NullTokens& nulls,
+                        ValidityBitmap* validity, size_type row_pos)
+{
+    std::vector<size_type> null_pos;
+    for (size_type i = 0, sz = fields.size(); i != sz; ++i)
+    {
+        if (nulls.contains(fields[i]))
+        {
+            null_pos.push_back(i);
+            if (validity)
+                validity->set_null(row_pos + i);
+        }
+    }
+
+    if constexpr (std::is_arithmetic_v<T>)
+    {
+        // decode_column() fails on empty fields only, which other nulls are replaced with
+        auto all_empty = std::all_of(null_pos.begin(), null_pos.end(), [&](auto i) {
+            return fields[i].empty();
+        });
+
+        if (all_empty)
+            return decode_column(fields, values) - null_pos.size();
+
+        std::vector<std::string_view> non_nulls {fields.begin(), fields.end()};
+        for (auto i : null_pos)
+            non_nulls[i] = {};
+
+        return decode_column(std::span<const std::string_view>{non_nulls}, values) - null_pos.size();
+    }
+    else
+    {
+        size_type n = 0;
+        for (size_type i = 0, k = 0, sz = fields.size(); i != sz; ++i)
+        {
+            if (k != null_pos.size() && null_pos[k] == i)
+            {
+                values[i] = T{};
+                ++k;
+            }
+            else if (!from_field(fields[i], values[i]))
+            {
+                values[i] = T{};
+                ++n;
+            }
+        }
+
+        return n;
+    }
+}
+
+// the field unquoted and unescaped as from_field() does for std::string, with s as the buffer
+inline std::string_view unescape(std::string_view sv, std::string& s)
+{
+    auto t = unquote(sv);
+    if (t.size() != sv.size() && t.find("\"\"") != std::string_view::npos)
+    {
+        from_field(sv, s);
+        t = s;
+    }
+
+    return t;
+}
+
+/**
+ * @brief encode a column of strings in parallel, i.e., dictionary-encode it into EncodedColumn
+ *        or pack it into StringColumn
+ *
+ * @details each chunk is encoded against a dictionary (or into a buffer) of its own with no
+ *          lock involved. these dictionaries are merged in the order of chunks afterwards,
+ *          and the codes are translated accordingly. the codes thus follow the order of the
+ *          first appearance of values in the file regardless of the number of threads.
+ *          the buffers are concatenated in the same way.
+ */
+class ColumnEncoder {
+public:
+    void resize(EncodedColumn& col, size_type row_num, size_type chunk_num)
+    {
+        col.codes.resize(row_num);
+        dicts.resize(chunk_num);
+    }
+
+    void resize(StringColumn& col, size_type row_num, size_type chunk_num)
+    {
+        col.offsets.assign(row_num + 1, 0);
+        bufs.resize(chunk_num);
+    }
+
+    /**
+     * @brief encode the fields of rows from row_pos on
+     *
+     * @details nulls are encoded as empty strings as encode(StringColumn&, ...) takes them,
+     *          so that every code is in the dictionary and no null token is taken as a value.
+     */
+    void encode(EncodedColumn& col, std::span<const std::string_view> fields, size_type row_pos,
+                size_type chunk, const NullTokens& nulls, ValidityBitmap* validity)
+    {
+        auto& dict = dicts[chunk];
+        std::string s;
+        for (size_type i = 0, sz = fields.size(); i != sz; ++i)
+        {
+            if (nulls.contains(fields[i]))
+            {
+                if (validity)
+                    validity->set_null(row_pos + i);
+
+                col.codes[row_pos + i] = dict.encode(std::string_view{});
+            }
+            else
+            {
+                col.codes[row_pos + i] = dict.encode(unescape(fields[i], s));
+            }
+        }
+    }
+
+    /**
+     * @brief append the fields of rows from row_pos on to the buffer of chunk
+     *
+     * @details nulls are taken as empty strings. the offsets are relative to the buffer
+     *          until merge().
+     */
+    void encode(StringColumn& col, std::span<const std::string_view> fields, size_type row_pos,
+                size_type chunk, const NullTokens& nulls, ValidityBitmap* validity)
+    {
+        auto& buf = bufs[chunk];
+        std::string s;
+        for (size_type i = 0, sz = fields.size(); i != sz; ++i)
+        {
+            if (nulls.contains(fields[i]))
+            {
+                if (validity)
+                    validity->set_null(row_pos + i);
+            }
+            else
+            {
+                buf.append(unescape(fields[i], s));
+            }
+
+            col.offsets[row_pos + i + 1] = static_cast<StringColumn::offset_type>(buf.size());
+        }
+    }
+
+    void merge(EncodedColumn& col, const std::vector<size_type>& offsets, size_type thread_num)
+    {
+        std::vector<std::vector<Dictionary::code_type>> maps(dicts.size());
+        for (size_type i = 0; i != dicts.size(); ++i)
+        {
+            for (Dictionary::code_type c = 0; c != dicts[i].size(); ++c)
+                maps[i].push_back(col.dictionary.encode(dicts[i][c]));
+        }
+
+        parallel_for(dicts.size(), thread_num, [&](size_type i) {
+            for (auto r = offsets[i]; r != offsets[i + 1]; ++r)
+                col.codes[r] = maps[i][col.codes[r]];
+        });
+
+        dicts.clear();
+    }
+
+    void merge(StringColumn& col, const std::vector<size_type>& offsets, size_type thread_num)
+    {
+        std::vector<size_type> bases(bufs.size() + 1, 0);
+        for (size_type i = 0; i != bufs.size(); ++i)
+            bases[i + 1] = bases[i] + bufs[i].size();
+
+        col.data.resize(bases.back());
+        parallel_for(bufs.size(), thread_num, [&](size_type i) {
+            std::memcpy(col.data.data() + bases[i], bufs[i].data(), bufs[i].size());
+            for (auto r = offsets[i]; r != offsets[i + 1]; ++r)
+                col.offsets[r + 1] += static_cast<StringColumn::offset_type>(bases[i]);
+
+            // release the memory as early as possible
+            std::string {}.swap(bufs[i]);
+        });
+
+        bufs.clear();
+    }
+
+private:
+    std::vector<Dictionary> dicts;
+    std::vector<std::string> bufs;
+};
+
+// pack a column of strings into one buffer
+inline StringColumn pack_strings(const std::vector<std::string>& strs)
+{
+    StringColumn col;
+    col.offsets.reserve(strs.size() + 1);
+    col.offsets.push_back(0);
+    for (const auto& s : strs)
+    {
+        col.data.insert(col.data.end(), s.begin(), s.end());
+        col.offsets.push_back(static_cast<StringColumn::offset_type>(col.data.size()));
+    }
+
+    return col;
+}
+
+// if a column of values is filled chunk by chunk via ColumnEncoder rather than in place
+template<typename C>
+inline constexpr bool is_encoded_v = std::is_same_v<C, EncodedColumn> || std::is_same_v<C, StringColumn>;
+
+/**
+ * @brief pre-size a column of values (i.e., std::vector<T>, EncodedColumn, or StringColumn)
+ *        along with its validity bitmap if any
+ */
+template<typename C>
+void resize_column(C& col, ValidityBitmap* validity, size_type row_num, size_type chunk_num,
+                   ColumnEncoder& encoder)
+{
+    if constexpr (is_encoded_v<C>)
+        encoder.resize(col, row_num, chunk_num);
+    else
+        col.resize(row_num);
+
+    if (validity)
+        validity->assign(row_num);
+}
+
+/**
+ * @brief convert the fields of rows from row_pos on into a column of values
+ *
+ * @return the number of non-null fields that cannot be converted
+ */
+template<typename C>
+size_type convert_column(C& col, ValidityBitmap* validity, std::span<const std::string_view> fields,
+                         size_type row_pos, size_type chunk, ColumnEncoder& encoder,
+                         const NullTokens& nulls)
+{
+    if constexpr (is_encoded_v<C>)
+    {
+        encoder.encode(col, fields, row_pos, chunk, nulls, validity);
+        return 0;
+    }
+    else
+    {
+        return decode_fields(fields, col.data() + row_pos, nulls, validity, row_pos);
+    }
+}
+
+// settle an encoded column once all the chunks are done
+template<typename C>
+void finish_column(C& col, const std::vector<size_type>& offsets, size_type thread_num,
+                   ColumnEncoder& encoder)
+{
+    if constexpr (is_encoded_v<C>)
+        encoder.merge(col, offsets, thread_num);
+}
+
+/**
+ * @brief parse the rows of src in parallel and hand over the fields of each column batch
+ *        by batch to their final positions, i.e., fn(j, fields, row_pos, chunk) for column j
+ *
+ * @details the rows are split into chunks at line endings, which are counted in parallel
+ *          first so that resize(row_num, chunk_num) is able to pre-size all the columns.
+ *
+ * @param fn a callable returning the number of fields that cannot be converted
+ * @return the index of the first row of each chunk, plus the total number of rows
+ */
+template<typename Resize, typename Fn>
+std::vector<size_type> scan_columns(const ColumnSource& src, const std::vector<size_type>& indices,
+                  const std::vector<std::string_view>& fieldnames, size_type thread_num,
+                  Resize resize, Fn fn)
+{
+    // rows converted at a time
+    static constexpr size_type BATCH_SIZE = 4096;
+
+    if (!thread_num)
+        thread_num = std::max(1u, std::thread::hardware_concurrency());
+
+    auto n = indices.size();
+    auto delim = src.get_delim();
+    auto chunks = src.split(thread_num * 4);
+
+    std::vector<size_type> offsets(chunks.size() + 1, 0);
+    parallel_for(chunks.size(), thread_num, [&](size_type i) {
+        offsets[i + 1] = ChunkReader{chunks[i], delim}.count_rows();
+    });
+
+    for (size_type i = 0; i != chunks.size(); ++i)
+        offsets[i + 1] += offsets[i];
+
+    resize(offsets.back(), chunks.size());
+
+    std::vector<std::atomic<size_type>> invalid_nums(n);
+    parallel_for(chunks.size(), thread_num, [&](size_type i) {
+        ChunkReader reader {chunks[i], delim};
+        RowView rv;
+        std::vector<std::vector<std::string_view>> fields(n);
+        for (auto& f : fields)
+            f.reserve(BATCH_SIZE);
+
+        auto row_pos = offsets[i];
+        auto flush = [&]() {
+            for (size_type j = 0; j != n; ++j)
+                invalid_nums[j] += fn(j, std::span<const std::string_view>{fields[j]}, row_pos, i);
+
+            row_pos += fields[0].size();
+            for (auto& f : fields)
+                f.clear();
+        };
+
+        while (reader.next(rv))
+        {
+            for (size_type j = 0; j != n; ++j)
+                fields[j].push_back(indices[j] < rv.size() ? rv[indices[j]] : std::string_view{});
+
+            if (fields[0].size() == BATCH_SIZE)
+                flush();
+        }
+
+        flush();
+    });
+
+    for (size_type j = 0; j != n; ++j)
+    {
+        if (invalid_nums[j])
+        {
+            std::cerr << "CAUTION: " << invalid_nums[j].load() << " fields of " << fieldnames[j]
+                      << " cannot be converted and are value-initialized!\n";
+        }
+    }
+
+    return offsets;
+}
+} // namespace detail
+
+/**
+ * @brief load columns of a csv file with headers into vectors of their own types, e.g.,
+ *
+ *  auto [ids, caps] = load_columns<long, double>("link.csv", {"link_id", "capacity"});
+ *
+ * @details it never builds a Row. the rows after the headers are split into chunks at line
+ *          endings, which are counted in parallel to pre-size all the vectors. each chunk
+ *          is then parsed in parallel and its fields are collected into batches per column
+ *          and converted via decode_column() (or from_field() for non-numeric types)
+ *          straight into their final positions.
+ *
+ *          nulls (i.e., fields matching any of the null tokens, which are empty ones by
+ *          default) and missing fields are value-initialized, and so are ill-formed ones
+ *          with a warning per column.
+ *
+ *          Dictionary in place of a type dictionary-encodes a low-cardinality column into
+ *          EncodedColumn, std::string_view packs a column of strings into StringColumn, and
+ *          Nullable<T> gives NullableColumn with a validity bitmap, e.g.,
+ *
+ *  auto [ids, types] = load_columns<long, Dictionary>("link.csv", {"link_id", "facility_type"});
+ *  auto [caps] = load_columns<Nullable<double>>("link.csv", {"capacity"}, ',', 0, {"", "NA"});
+ *
+ * @note NoRecord will be thrown if a fieldname is nonexistent. bool is not supported as
+ *       std::vector<bool> packs its elements into bits, and integral types (e.g., char) taking
+ *       1/0 shall be used instead.
+ *
+ * @param fieldnames the headers of the columns to load, one per type in Ts
+ * @param thread_num the number of threads. zero means all the hardware threads.
+ * @param nulls the tokens of missing values
+ * @return a tuple of columns, i.e., std::vector<T>, EncodedColumn, StringColumn, or
+ *         NullableColumn
+ */
+template<typename... Ts>
+std::tuple<detail::column_of_t<Ts>...> load_columns(const std::string& path,
+                                                    const std::array<std::string_view, sizeof...(Ts)>& fieldnames,
+                                                    const char delim = ',', size_type thread_num = 0,
+                                                    const NullTokens& nulls = {})
+{
+    static_assert(sizeof...(Ts) > 0, "load_columns() takes at least one column");
+    static_assert((!std::is_same_v<Ts, bool> && ...),
+                  "std::vector<bool> cannot be filled in parallel. use an integral type instead");
+
+    detail::ColumnSource src {path, delim};
+
+    std::vector<size_type> indices;
+    for (auto s : fieldnames)
+        indices.push_back(src.column(s).get_index());
+
+    std::tuple<detail::column_of_t<Ts>...> columns;
+    std::array<detail::ColumnEncoder, sizeof...(Ts)> encoders;
+
+    // invoke fn(std::integral_constant<std::size_t, I>) for each column I
+    auto for_each_column = [](auto fn) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (fn(std::integral_constant<std::size_t, I>{}), ...);
+        }(std::index_sequence_for<Ts...>{});
+    };
+
+    auto resize = [&](size_type row_num, size_type chunk_num) {
+        for_each_column([&](auto I) {
+            auto& col = std::get<I>(columns);
+            detail::resize_column(detail::values_of(col), detail::validity_of(col), row_num,
+                                  chunk_num, encoders[I]);
+        });
+    };
+
+    auto convert = [&](size_type j, std::span<const std::string_view> fields, size_type row_pos,
+                       size_type chunk) {
+        size_type n = 0;
+        for_each_column([&](auto I) {
+            if (I != j)
+                return;
+
+            auto& col = std::get<I>(columns);
+            n = detail::convert_column(detail::values_of(col), detail::validity_of(col), fields,
+                                       row_pos, chunk, encoders[I], nulls);
+        });
+
+        return n;
+    };
+
+    auto offsets = detail::scan_columns(src, indices, {fieldnames.begin(), fieldnames.end()},
+                                        thread_num, resize, convert);
+
+    for_each_column([&](auto I) {
+        detail::finish_column(detail::values_of(std::get<I>(columns)), offsets, thread_num,
+                              encoders[I]);
+    });
+
+    return columns;
+}
+
+/**
+ * @brief the types inferred for columns, from the narrowest to the widest
+ *
+ * @details Integer widens to Float and Date widens to DateTime. any other two distinct
+ *          types fall back to String. Null stands for a column with no nonempty field.
+ */
+enum class ColumnType { Null, Boolean, Integer, Float, Date, DateTime, String };
+
+inline std::ostream& operator<<(std::ostream& os, ColumnType t)
+{
+    static constexpr const char* names[] = {"null", "boolean", "integer", "float",
+                                            "date", "datetime", "string"};
+    return os << names[static_cast<int>(t)];
+}
+
+// a point in time in microseconds since the Unix epoch
+using Timestamp = std::chrono::sys_time<std::chrono::microseconds>;
+
+/**
+ * @brief infer the type of a single field
+ */
+inline ColumnType infer_type(std::string_view sv)
+{
+    sv = unquote(sv);
+    if (sv.empty())
+        return ColumnType::Null;
+
+    if (bool b; from_field(sv, b) && sv != "0" && sv != "1")
+        return ColumnType::Boolean;
+
+    if (std::int64_t i; parse_integer(sv.data(), sv.data() + sv.size(), i))
+        return ColumnType::Integer;
+
+    if (double d; parse_float(sv.data(), sv.data() + sv.size(), d))
+        return ColumnType::Float;
+
+    if (Timestamp t;
+        parse_datetime(sv.data(), sv.data() + sv.size(), t))
+        return sv.size() == 10 ? ColumnType::Date : ColumnType::DateTime;
+
+    return ColumnType::String;
+}
+
+/**
+ * @brief the narrowest type taking both a and b
+ */
+inline ColumnType merge_types(ColumnType a, ColumnType b)
+{
+    if (a == b || b == ColumnType::Null)
+        return a;
+
+    if (a == ColumnType::Null)
+        return b;
+
+    auto [x, y] = std::minmax(a, b);
+    if ((x == ColumnType::Integer && y == ColumnType::Float)
+        || (x == ColumnType::Date && y == ColumnType::DateTime))
+        return y;
+
+    return ColumnType::String;
+}
+
+struct ColumnSchema {
+    std::string name;
+    ColumnType type = ColumnType::Null;
+    // if any empty or missing field is seen
+    bool nullable = false;
+    // the largest number of chars of a field, exclusive of the enclosing double quotes
+    size_type max_width = 0;
+    // the number of distinct non-empty values in the sample
+    size_type distinct_num = 0;
+    // if a String column is to be dictionary-encoded, i.e., at least half of the sample repeats
+    bool encoded = false;
+};
+
+/**
+ * @brief the types and other properties of columns inferred from a sample of rows
+ */
+class Schema {
+public:
+    using const_iterator = std::vector<ColumnSchema>::const_iterator;
+
+    Schema() = default;
+
+    explicit Schema(const FieldNames& fns)
+    {
+        for (const auto& [name, i] : fns)
+        {
+            if (i >= columns.size())
+                columns.resize(i + 1);
+
+            columns[i].name = name;
+        }
+
+        distinct_values.resize(columns.size());
+        headed = true;
+    }
+
+    const ColumnSchema& operator[](size_type i) const
+    {
+        if (i >= columns.size())
+            throw NoRecord{i};
+
+        return columns[i];
+    }
+
+    const ColumnSchema& operator[](std::string_view s) const
+    {
+        auto it = std::find_if(columns.begin(), columns.end(), [s](const auto& c) {
+            return c.name == s;
+        });
+
+        if (it == columns.end())
+            throw NoRecord{std::string{s}};
+
+        return *it;
+    }
+
+    // override the inferred properties, e.g., schema["facility_type"].encoded = false
+    ColumnSchema& operator[](size_type i)
+    {
+        return const_cast<ColumnSchema&>(std::as_const(*this)[i]);
+    }
+
+    ColumnSchema& operator[](std::string_view s)
+    {
+        return const_cast<ColumnSchema&>(std::as_const(*this)[s]);
+    }
+
+    const_iterator begin() const
+    {
+        return columns.begin();
+    }
+
+    const_iterator end() const
+    {
+        return columns.end();
+    }
+
+    size_type size() const
+    {
+        return columns.size();
+    }
+
+    // the number of rows sampled
+    size_type get_sample_num() const
+    {
+        return sample_num;
+    }
+
+    /**
+     * @brief refine the schema with one more row, where nulls are taken as empty fields
+     *
+     * @details fields beyond the headers, if any, are left out as no loader could resolve
+     *          them by name. a schema without headers grows with the widest row instead.
+     */
+    template<typename R>
+    void sample(const R& r, const NullTokens& nulls = {})
+    {
+        auto n = headed ? columns.size() : std::max(columns.size(), r.size());
+        for (size_type i = 0; i != n; ++i)
+        {
+            if (i == columns.size())
+            {
+                columns.push_back({std::to_string(i), ColumnType::Null, sample_num > 0});
+                distinct_values.emplace_back();
+            }
+
+            auto& c = columns[i];
+            auto sv = i < r.size() && !nulls.contains(r[i]) ? unquote(r[i]) : std::string_view{};
+            c.nullable |= sv.empty();
+            c.max_width = std::max(c.max_width, static_cast<size_type>(sv.size()));
+            c.type = merge_types(c.type, infer_type(sv));
+
+            if (!sv.empty())
+            {
+                distinct_values[i].encode(sv);
+                c.distinct_num = distinct_values[i].size();
+            }
+        }
+
+        ++sample_num;
+        for (auto& c : columns)
+            c.encoded = c.type == ColumnType::String && c.distinct_num * 2 <= sample_num;
+    }
+
+private:
+    std::vector<ColumnSchema> columns;
+    // the distinct values of each column in the sample
+    std::vector<Dictionary> distinct_values;
+    size_type sample_num = 0;
+    // if columns are given by headers
+    bool headed = false;
+};
+
+/**
+ * @brief infer the schema of a csv file with headers from a sample of its rows
+ *
+ * @details it samples either the first sample_num rows or the rows at sample_num random
+ *          offsets, where the latter covers a large file more evenly at the same cost.
+ *          the sampling is deterministic for the same file.
+ *
+ * @note fields beyond the headers are left out of the schema.
+ *
+ * @param nulls the tokens of missing values, which tell nothing about the types
+ */
+inline Schema infer_schema(const std::string& path, size_type sample_num = 1000,
+                           const char delim = ',', bool random = false, const NullTokens& nulls = {})
+{
+    detail::ColumnSource src {path, delim};
+    Schema schema {src.get_fieldnames()};
+
+    RowView rv;
+    auto body = src.body();
+    if (!random)
+    {
+        detail::ChunkReader reader {body, delim};
+        for (size_type i = 0; i != sample_num && reader.next(rv); ++i)
+            schema.sample(rv, nulls);
+
+        return schema;
+    }
+
+    std::mt19937_64 gen {body.size()};
+    std::uniform_int_distribution<size_type> dist {0, body.empty() ? 0 : body.size() - 1};
+    for (size_type i = 0; i != sample_num && !body.empty(); ++i)
+    {
+        // move on to the beginning of the next row unless it is the first one
+        auto pos = dist(gen);
+        if (pos)
+        {
+            pos = body.find('\n', pos - 1);
+            if (pos == std::string_view::npos || ++pos == body.size())
+                pos = 0;
+        }
+
+        detail::ChunkReader reader {body.substr(pos), delim};
+        if (reader.next(rv))
+            schema.sample(rv, nulls);
+    }
+
+    return schema;
+}
+
+/**
+ * @brief a column loaded as per its inferred type
+ *
+ * @details Boolean goes to std::vector<char> holding 1/0, Date to std::chrono::sys_days,
+ *          DateTime to Timestamp, and String to EncodedColumn if ColumnSchema::encoded is set
+ *          or to StringColumn if packed as requested by load_table().
+ */
+using ColumnVector = std::variant<std::vector<std::int64_t>, std::vector<double>, std::vector<char>,
+                                  std::vector<std::chrono::sys_days>, std::vector<Timestamp>,
+                                  std::vector<std::string>, EncodedColumn, StringColumn>;
+
+/**
+ * @brief columns loaded as per a schema along with their validity bitmaps
+ */
+struct Table {
+    Schema schema;
+    std::vector<ColumnVector> columns;
+    std::vector<ValidityBitmap> validity;
+
+    size_type row_num() const
+    {
+        return validity.empty() ? 0 : validity.front().size();
+    }
+};
+
+/**
+ * @brief load all the columns of a csv file with headers as per a schema, e.g.,
+ *
+ *  auto schema = infer_schema("link.csv");
+ *  auto table = load_table("link.csv", schema, ',', 0, {"", "NA"});
+ *
+ * @details nulls (i.e., fields matching any of the null tokens) are value-initialized and
+ *          marked in the validity bitmap of their columns.
+ *
+ * @note NoRecord will be thrown if a column of the schema is not in the headers.
+ *
+ * @param packed if String columns not encoded are packed into StringColumn rather than
+ *        std::vector<std::string>
+ * @return the columns in the order of the schema
+ */
+inline Table load_table(const std::string& path, const Schema& schema, const char delim = ',',
+                        size_type thread_num = 0, const NullTokens& nulls = {}, bool packed = false)
+{
+    detail::ColumnSource src {path, delim};
+
+    std::vector<size_type> indices;
+    std::vector<std::string_view> fieldnames;
+    Table table {schema, {}, std::vector<ValidityBitmap>(schema.size())};
+    auto& columns = table.columns;
+    for (const auto& c : schema)
+    {
+        indices.push_back(src.column(c.name).get_index());
+        fieldnames.push_back(c.name);
+
+        switch (c.type)
+        {
+        case ColumnType::Boolean:
+            columns.emplace_back(std::vector<char>{});
+            break;
+        case ColumnType::Integer:
+            columns.emplace_back(std::vector<std::int64_t>{});
+            break;
+        case ColumnType::Float:
+            columns.emplace_back(std::vector<double>{});
+            break;
+        case ColumnType::Date:
+            columns.emplace_back(std::vector<std::chrono::sys_days>{});
+            break;
+        case ColumnType::DateTime:
+            columns.emplace_back(std::vector<Timestamp>{});
+            break;
+        case ColumnType::String:
+            if (c.encoded)
+            {
+                columns.emplace_back(EncodedColumn{});
+                break;
+            }
+            if (packed)
+            {
+                columns.emplace_back(StringColumn{});
+                break;
+            }
+            [[fallthrough]];
+        default:
+            columns.emplace_back(std::vector<std::string>{});
+        }
+    }
+
+    std::vector<detail::ColumnEncoder> encoders(columns.size());
+    auto resize = [&](size_type row_num, size_type chunk_num) {
+        for (size_type j = 0; j != columns.size(); ++j)
+        {
+            std::visit([&](auto& col) {
+                detail::resize_column(col, &table.validity[j], row_num, chunk_num, encoders[j]);
+            }, columns[j]);
+        }
+    };
+
+    auto convert = [&](size_type j, std::span<const std::string_view> fields, size_type row_pos,
+                       size_type chunk) {
+        auto& validity = table.validity[j];
+        if (auto* vec = std::get_if<std::vector<char>>(&columns[j]))
+        {
+            // true/false rather than 1/0
+            size_type n = 0;
+            for (size_type i = 0; i != fields.size(); ++i)
+            {
+                bool b = false;
+                if (nulls.contains(fields[i]))
+                    validity.set_null(row_pos + i);
+                else if (!from_field(fields[i], b))
+                    ++n;
+
+                (*vec)[row_pos + i] = b;
+            }
+
+            return n;
+        }
+
+        return std::visit([&](auto& col) {
+            return detail::convert_column(col, &validity, fields, row_pos, chunk, encoders[j], nulls);
+        }, columns[j]);
+    };
+
+    auto offsets = detail::scan_columns(src, indices, fieldnames, thread_num, resize, convert);
+    for (size_type j = 0; j != columns.size(); ++j)
+    {
+        std::visit([&](auto& col) {
+            detail::finish_column(col, offsets, thread_num, encoders[j]);
+        }, columns[j]);
+    }
+
+    return table;
+}
+
+/**
+ * @brief load all the columns of a csv file with headers as per a schema, e.g.,
+ *
+ *  auto schema = infer_schema("link.csv");
+ *  auto columns = load_columns("link.csv", schema);
+ *
+ * @note it is load_table() without the validity bitmaps.
+ *
+ * @return the columns in the order of the schema
+ */
+inline std::vector<ColumnVector> load_columns(const std::string& path, const Schema& schema,
+                                              const char delim = ',', size_type thread_num = 0,
+                                              const NullTokens& nulls = {})
+{
+    return std::move(load_table(path, schema, delim, thread_num, nulls).columns);
+}
+
+} // namespace miocsv
+
+#endif
@@ -13,6 +13,23 @@
 #include "mio/mio.hpp"
 #include "stdcsv.h"
 
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <tuple>
+#include <utility>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #ifdef __GNUC__
 #define semi_branch_expect(x, y) __builtin_expect(x, y)
 #else
@@ -21,12 +38,247 @@
 
 namespace miocsv
 {
-class MIOReader : public virtual BaseReader {
+/**
+ * @brief the common base of all readers parsing a contiguous range of chars [it, it_end)
+ *
+ * @details derived readers only need to decide where the range comes from (e.g., a memory
+ *          mapped file or a decompressed buffer) and BaseMIOReader::parse() takes care of the rest.
+ */
+class BaseMIOReader : public virtual BaseReader {
+public:
+    BaseMIOReader() = delete;
+
+    explicit BaseMIOReader(const char delim_)
+        : BaseReader{}, delim {delim_}, it {nullptr}, it_end {nullptr}
+    {
+    }
+
+    template<typename T, typename... Ms>
+    class Binder;
+
+    /**
+     * @brief bind columns to data members of a user struct, e.g.,
+     *
+     *  auto links = reader.bind<Link>(&Link::id, "link_id", &Link::cap, "capacity");
+     *  for (const Link& link : links)
+     *      ...
+     *
+     * @details columns, given by fieldnames (only for DictReaders) or indices, are resolved
+     *          once here. each field is then converted from the source chars directly into
+     *          its data member via from_field() with no Row (and no std::string) involved.
+     *
+     *          an empty or missing field leaves its data member value-initialized, and so
+     *          does an ill-formed one with a warning.
+     *
+     * @note NoRecord will be thrown if a fieldname is nonexistent.
+     *
+     * @param args pairs of a pointer to data member of T and a fieldname or an index
+     * @return a range of T, which is only valid along with the reader
+     */
+    template<typename T, typename... Args>
+    auto bind(const Args&... args)
+    {
+        static_assert(sizeof...(Args) % 2 == 0, "bind() takes pairs of member and column");
+
+        return make_binder<T>(std::forward_as_tuple(args...),
+                              std::make_index_sequence<sizeof...(Args) / 2>{});
+    }
+
+protected:
+    const char delim;
+    const char* it;
+    const char* it_end;
+
+    bool iterate() override
+    {
+        // EOF is reached
+        while (it == it_end)
+        {
+            if (!refill())
+                return false;
+        }
+
+        row = parse();
+        ++row_num;
+        return true;
+    }
+
+    /**
+     * @brief the counterpart of iterate() parsing the next row into views
+     */
+    virtual bool iterate_view(RowView& rv)
+    {
+        while (it == it_end)
+        {
+            if (!refill())
+                return false;
+        }
+
+        rv.clear();
+        parse(rv);
+        ++row_num;
+        return true;
+    }
+
+    /**
+     * @brief make more chars available once it reaches it_end, e.g., from the next file
+     *
+     * @return false if EOF is reached, true otherwise.
+     */
+    virtual bool refill()
+    {
+        return false;
+    }
+
+    Row parse()
+    {
+        Row r;
+        parse(r);
+        return r;
+    }
+
+    /**
+     * @brief parse the next row into r, which could be Row or RowView
+     */
+    template<typename R>
+    void parse(R& r);
+
+private:
+    size_type resolve(std::string_view s) const
+    {
+        const auto* p = dynamic_cast<const BaseDictReader*>(this);
+        auto i = p ? p->get_fieldnames().find(s) : FieldNames::npos;
+        if (i == FieldNames::npos)
+            throw NoRecord{std::string{s}};
+
+        return i;
+    }
+
+    size_type resolve(size_type i) const
+    {
+        return i;
+    }
+
+    template<typename T, typename Tuple, std::size_t... I>
+    auto make_binder(const Tuple& t, std::index_sequence<I...>)
+    {
+        using B = Binder<T, std::decay_t<std::tuple_element_t<2 * I, Tuple>>...>;
+        return B {this, {resolve(std::get<2 * I + 1>(t))...}, {std::get<2 * I>(t)...}};
+    }
+};
+
+template<typename T, typename... Ms>
+class BaseMIOReader::Binder {
+public:
+    static constexpr std::size_t N = sizeof...(Ms);
+
+    Binder(BaseMIOReader* r_, std::array<size_type, N> indices_, std::tuple<Ms...> members_)
+        : r {r_}, indices {indices_}, members {members_}
+    {
+    }
+
+    class iterator {
+    public:
+        explicit iterator(Binder* b_) : b {b_}
+        {
+            if (b && !b->next())
+                b = nullptr;
+        }
+
+        iterator& operator++()
+        {
+            if (!b->next())
+                b = nullptr;
+
+            return *this;
+        }
+
+        bool operator==(const iterator& it) const
+        {
+            return b == it.b;
+        }
+
+        bool operator!=(const iterator& it) const
+        {
+            return b != it.b;
+        }
+
+        const T& operator*() const
+        {
+            return b->rec;
+        }
+
+    private:
+        Binder* b;
+    };
+
+    iterator begin()
+    {
+        return iterator{this};
+    }
+
+    iterator end()
+    {
+        return iterator{nullptr};
+    }
+
+    // bind all the remaining rows
+    std::vector<T> to_vector()
+    {
+        std::vector<T> vec;
+        while (next())
+            vec.push_back(rec);
+
+        return vec;
+    }
+
+private:
+    BaseMIOReader* r;
+    std::array<size_type, N> indices;
+    std::tuple<Ms...> members;
+
+    RowView rv;
+    T rec {};
+
+    bool next()
+    {
+        if (!r->iterate_view(rv))
+            return false;
+
+        assign(std::make_index_sequence<N>{});
+        return true;
+    }
+
+    template<std::size_t... I>
+    void assign(std::index_sequence<I...>)
+    {
+        (assign_field(rec.*std::get<I>(members), indices[I]), ...);
+    }
+
+    template<typename F>
+    void assign_field(F& f, size_type i)
+    {
+        auto sv = i < rv.size() ? rv[i] : std::string_view{};
+        if (sv.empty() || from_field(sv, f))
+        {
+            if (sv.empty())
+                f = F{};
+
+            return;
+        }
+
+        std::cerr << "CAUTION: Invalid field at line " << r->row_num
+                  << "! Value cannot be converted: " << sv << ".\n";
+        f = F{};
+    }
+};
+
+class MIOReader : public BaseMIOReader {
 public:
     MIOReader() = delete;
 
     MIOReader(const std::string& ms_, const char delim_ = ',')
-        : BaseReader{}, ms {ms_}, delim {delim_}
+        : BaseReader{}, BaseMIOReader{delim_}, ms {ms_}
     {
         if (!ms.is_mapped())
         {
@@ -35,10 +287,11 @@ public:
         }
 
         it = ms.begin();
+        it_end = ms.end();
     }
 
     MIOReader(std::string&& ms_, const char delim_ = ',')
-        : BaseReader{}, ms {ms_}, delim {delim_}
+        : BaseReader{}, BaseMIOReader{delim_}, ms {ms_}
     {
         if (!ms.is_mapped())
         {
@@ -47,6 +300,7 @@ public:
         }
 
         it = ms.begin();
+        it_end = ms.end();
     }
 
     ~MIOReader()
@@ -56,21 +310,6 @@ public:
 
 protected:
     mio::mmap_source ms;
-    const char delim;
-    const char* it;
-
-    void iterate() override
-    {
-        // EOF is reached
-        if (it == ms.end())
-            throw IterationEnd{};
-
-        row = parse();
-        ++row_num;
-    }
-
-private:
-    Row parse();
 };
 
 class MIODictReader : public MIOReader, public BaseDictReader {
@@ -90,63 +329,1258 @@ public:
     }
 
 private:
-    void iterate() override
+    bool iterate() override
     {
-        MIOReader::iterate();
         // do not take blank lines
-        while (row.empty())
-            MIOReader::iterate();
+        do
+        {
+            if (!MIOReader::iterate())
+                return false;
+        } while (row.empty());
 
         if (row_num > 1)
             attach_fieldnames(row, &fns, row_num);
+
+        return true;
+    }
+
+    bool iterate_view(RowView& rv) override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!MIOReader::iterate_view(rv))
+                return false;
+        } while (rv.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(rv, &fns, row_num);
+
+        return true;
     }
 };
 
-Row MIOReader::parse()
+/**
+ * @brief run fn(i) for i in [0, n) over a number of threads
+ *
+ * @details tasks are handed out one at a time through an atomic counter so that threads
+ *          taking long tasks (e.g., large files) do not hold up the others. the first
+ *          exception thrown by fn, if any, is rethrown after all the threads are joined.
+ *
+ * @param thread_num the number of threads. zero means all the hardware threads.
+ */
+template<typename Fn>
+void parallel_for(size_type n, size_type thread_num, Fn fn)
+{
+    if (!thread_num)
+        thread_num = std::max(1u, std::thread::hardware_concurrency());
+
+    std::atomic<size_type> next {0};
+    std::exception_ptr ep;
+    std::mutex mtx;
+
+    auto worker = [&]() {
+        for (auto i = next++; i < n; i = next++)
+        {
+            try
+            {
+                fn(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lk {mtx};
+                if (!ep)
+                    ep = std::current_exception();
+                // stop handing out tasks
+                next = n;
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_type k = 1, m = std::min(thread_num, n); k < m; ++k)
+        workers.emplace_back(worker);
+
+    // the calling thread is one of the workers
+    worker();
+    for (auto& w : workers)
+        w.join();
+
+    if (ep)
+        std::rethrow_exception(ep);
+}
+
+/**
+ * @brief list the files matching a pattern in lexicographical order
+ *
+ * @details '*' matches any sequence of chars and '?' matches any single char. wildcards are
+ *          only allowed in the filename, e.g., "data/part-*.csv", but not in the directory.
+ */
+inline std::vector<std::string> glob(const std::string& pattern)
 {
-    Row r;
-    auto quoted = false;
-    StringRange<const char*> sr{it};
+    namespace fs = std::filesystem;
 
-    // caution: the last line might be null terminated rather than '\n'
-    while (true)
+    // iterative wildcard matching with backtracking to the last '*'
+    auto match = [](const std::string& p, const std::string& s) {
+        size_type i = 0, j = 0, star = std::string::npos, mark = 0;
+        while (j < s.size())
+        {
+            if (i < p.size() && (p[i] == '?' || p[i] == s[j]))
+            {
+                ++i;
+                ++j;
+            }
+            else if (i < p.size() && p[i] == '*')
+            {
+                star = i++;
+                mark = j;
+            }
+            else if (star != std::string::npos)
+            {
+                i = star + 1;
+                j = ++mark;
+            }
+            else
+                return false;
+        }
+
+        while (i < p.size() && p[i] == '*')
+            ++i;
+
+        return i == p.size();
+    };
+
+    fs::path pp {pattern};
+    auto dir = pp.has_parent_path() ? pp.parent_path() : fs::path{"."};
+    auto filename = pp.filename().string();
+
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator{dir, ec})
+    {
+        if (entry.is_regular_file() && match(filename, entry.path().filename().string()))
+            paths.push_back(entry.path().string());
+    }
+
+    std::sort(paths.begin(), paths.end());
+    return paths;
+}
+
+/**
+ * @brief parse a list of csv files as one logical stream
+ *
+ * rows are numbered globally across files. the next file is mapped (and its pages are
+ * faulted in) on a background thread while the current one is being parsed.
+ *
+ * @note use miocsv::glob() to build the list from a pattern, e.g., "data/part-*.csv".
+ */
+class MultiFileReader : public BaseMIOReader {
+public:
+    MultiFileReader() = delete;
+
+    MultiFileReader(const std::vector<std::string>& paths_, const char delim_ = ',')
+        : BaseReader{}, BaseMIOReader{delim_}, paths {paths_}
+    {
+        prefetch();
+    }
+
+    MultiFileReader(std::vector<std::string>&& paths_, const char delim_ = ',')
+        : BaseReader{}, BaseMIOReader{delim_}, paths {std::move(paths_)}
+    {
+        prefetch();
+    }
+
+    ~MultiFileReader()
+    {
+        if (next.valid())
+            next.wait();
+    }
+
+    /**
+     * @brief the index of the file that the current row comes from
+     */
+    size_type get_file_index() const
+    {
+        return file_pos - 1;
+    }
+
+    const std::vector<std::string>& get_paths() const
+    {
+        return paths;
+    }
+
+    /**
+     * @brief parse all the files concurrently and invoke fn(row, row_num) on each row
+     *
+     * @details files are first counted in parallel to settle the global row numbers, and
+     *          then parsed in parallel. fn is invoked concurrently from different threads
+     *          but always sequentially for rows of the same file.
+     *
+     * @note it is independent of the iteration via begin() and end().
+     *
+     * @param fn a callable taking (const Row&, size_type)
+     * @param thread_num the number of threads. zero means all the hardware threads.
+     */
+    template<typename Fn>
+    void parallel_for_each(Fn fn, size_type thread_num = 0) const;
+
+protected:
+    std::vector<std::string> paths;
+    // index of the next file to open
+    size_type file_pos = 0;
+    // number of rows parsed from the current file
+    size_type file_row_num = 0;
+
+    mio::mmap_source ms;
+    std::future<mio::mmap_source> next;
+
+    // an empty file cannot be mapped and is skipped
+    static bool is_empty(const std::string& path)
+    {
+        std::error_code ec;
+        return !std::filesystem::file_size(path, ec) && !ec;
+    }
+
+    bool iterate() override
+    {
+        if (!BaseMIOReader::iterate())
+            return false;
+
+        ++file_row_num;
+        return true;
+    }
+
+    bool iterate_view(RowView& rv) override
+    {
+        if (!BaseMIOReader::iterate_view(rv))
+            return false;
+
+        ++file_row_num;
+        return true;
+    }
+
+    /**
+     * @brief a single file parsed by a worker thread of parallel_for_each()
+     */
+    class FilePart : public MIOReader {
+    public:
+        FilePart(const std::string& ms_, const char delim_)
+            : BaseReader{}, MIOReader{ms_, delim_}
+        {
+        }
+
+        // no exception to terminate
+        bool next()
+        {
+            if (it == it_end)
+                return false;
+
+            row = parse();
+            ++row_num;
+            return true;
+        }
+
+        Row& get_row()
+        {
+            return row;
+        }
+
+        size_type count_rows() const
+        {
+            auto n = static_cast<size_type>(std::count(it, it_end, LF));
+            // the last row without line ending
+            if (it != it_end && *(it_end - 1) != LF)
+                ++n;
+
+            return n;
+        }
+    };
+
+    /**
+     * @brief the global row number of the first row of each file, minus one
+     *
+     * @param header_num the number of header rows to drop from each file except the
+     * first one
+     */
+    std::vector<size_type> count_rows(size_type header_num, size_type thread_num) const;
+
+private:
+    void prefetch()
+    {
+        if (file_pos == paths.size())
+            return;
+
+        next = std::async(std::launch::async, [path = paths[file_pos]]() {
+            mio::mmap_source m;
+            if (!is_empty(path))
+                m = mio::mmap_source {path};
+
+            // fault in the pages ahead of parsing
+            volatile char c = 0;
+            for (size_type i = 0, sz = m.size(); i < sz; i += 4096)
+                c = c + m[i];
+
+            return m;
+        });
+    }
+
+    // move on to the next file
+    bool refill() override
+    {
+        if (!next.valid())
+            return false;
+
+        ms = next.get();
+        ++file_pos;
+        file_row_num = 0;
+        prefetch();
+
+        it = ms.begin();
+        it_end = ms.end();
+        return true;
+    }
+};
+
+class MultiFileDictReader : public MultiFileReader, public BaseDictReader {
+public:
+    MultiFileDictReader() = delete;
+
+    /**
+     * @param paths_ a list of csv files sharing the same headers
+     * @param fieldnames_ if it is empty, the first row of the first file will be taken as
+     * headers. the first row of every other file must be identical to it and is skipped.
+     * otherwise, every row of every file is data.
+     */
+    MultiFileDictReader(const std::vector<std::string>& paths_, const Row& fieldnames_ = {},
+                        const char delim_ = ',')
+        : MultiFileReader{paths_, delim_}, BaseDictReader{}
+    {
+        setup(fieldnames_);
+    }
+
+    MultiFileDictReader(std::vector<std::string>&& paths_, const Row& fieldnames_ = {},
+                        const char delim_ = ',')
+        : MultiFileReader{std::move(paths_), delim_}, BaseDictReader{}
+    {
+        setup(fieldnames_);
+    }
+
+    template<typename Fn>
+    void parallel_for_each(Fn fn, size_type thread_num = 0) const;
+
+private:
+    // headers from the first file, empty if fieldnames are provided by users
+    std::vector<std::string> headers;
+
+    void setup(const Row& fieldnames_)
+    {
+        setup_headers(fieldnames_);
+        if (fieldnames_.empty())
+            headers.assign(row.begin(), row.end());
+    }
+
+    template<typename R>
+    void check_headers(const R& r, size_type file_index) const
+    {
+        if (!std::equal(r.begin(), r.end(), headers.begin(), headers.end()))
+        {
+            std::cerr << "inconsistent headers in " << paths[file_index] << "!\n";
+            std::terminate();
+        }
+    }
+
+    bool iterate() override
     {
-        if (*it == quote)
+        while (true)
+        {
+            if (!MultiFileReader::iterate())
+                return false;
+
+            // do not take blank lines
+            if (row.empty())
+                continue;
+
+            // the headers from any file other than the first one are verified and skipped
+            if (!headers.empty() && file_row_num == 1 && get_file_index() > 0)
+            {
+                check_headers(row, get_file_index());
+                --row_num;
+                continue;
+            }
+
+            break;
+        }
+
+        if (row_num > 1)
+            attach_fieldnames(row, &fns, row_num);
+
+        return true;
+    }
+
+    bool iterate_view(RowView& rv) override
+    {
+        while (true)
+        {
+            if (!MultiFileReader::iterate_view(rv))
+                return false;
+
+            // do not take blank lines
+            if (rv.empty())
+                continue;
+
+            if (!headers.empty() && file_row_num == 1 && get_file_index() > 0)
+            {
+                check_headers(rv, get_file_index());
+                --row_num;
+                continue;
+            }
+
+            break;
+        }
+
+        if (row_num > 1)
+            attach_fieldnames(rv, &fns, row_num);
+
+        return true;
+    }
+};
+
+/**
+ * @brief a reader to be reused over a large number of small csv files
+ *
+ * @details the fixed cost per file is kept low by
+ *          1. reading a file below the threshold into a buffer reused across files rather
+ *             than mapping it, which saves a pair of mmap and munmap (and page faults);
+ *          2. reporting failures on opening a file via the return value of open() rather
+ *             than throwing.
+ *
+ *          call open() on each file and then iterate it as any other reader.
+ */
+class BatchReader : public BaseMIOReader {
+public:
+    /**
+     * @param delim_ a single character delimiter
+     * @param threshold_ files smaller than it (in bytes) are read rather than mapped
+     */
+    explicit BatchReader(const char delim_ = ',', size_type threshold_ = 1 << 16)
+        : BaseReader{}, BaseMIOReader{delim_}, threshold {threshold_}
+    {
+    }
+
+    /**
+     * @brief switch to a new file and rewind
+     *
+     * @return false if the file cannot be opened, true otherwise.
+     */
+    bool open(const std::string& path);
+
+protected:
+    size_type threshold;
+    // the buffer reused by small files
+    std::vector<char> buf;
+    mio::mmap_source ms;
+};
+
+class BatchDictReader : public BatchReader, public BaseDictReader {
+public:
+    /**
+     * @param fieldnames_ if it is empty, the first row of each file will be taken as headers.
+     * otherwise, every row of every file is data.
+     */
+    explicit BatchDictReader(const Row& fieldnames_ = {}, const char delim_ = ',',
+                             size_type threshold_ = 1 << 16)
+        : BatchReader{delim_, threshold_}, BaseDictReader{}, fixed_fns {!fieldnames_.empty()}
+    {
+        if (fixed_fns)
+            setup_headers(fieldnames_);
+    }
+
+    /**
+     * @brief switch to a new file, rewind, and set up its headers
+     *
+     * @note fieldnames are only rebuilt if the headers differ from the previous file's.
+     *
+     * @return false if the file cannot be opened, true otherwise.
+     */
+    bool open(const std::string& path)
+    {
+        if (!BatchReader::open(path))
+            return false;
+
+        if (fixed_fns)
+            return true;
+
+        // skip leading blank lines, which are not headers
+        auto first = it;
+        auto eol = std::find(first, it_end, LF);
+        while (eol != it_end && (eol == first || (eol - first == 1 && *first == CR)))
+        {
+            first = eol + 1;
+            eol = std::find(first, it_end, LF);
+        }
+
+        std::string_view header {first, static_cast<size_type>(eol - first)};
+        if (!fns.empty() && header == raw_headers)
+        {
+            it = eol == it_end ? eol : eol + 1;
+            row_num = 1;
+        }
+        else
+        {
+            raw_headers.assign(header);
+            fns.clear();
+            it = first;
+            setup_headers({});
+        }
+
+        return true;
+    }
+
+private:
+    // fieldnames are provided by users
+    const bool fixed_fns;
+    std::string raw_headers;
+
+    bool iterate() override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!BatchReader::iterate())
+                return false;
+        } while (row.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(row, &fns, row_num);
+
+        return true;
+    }
+
+    bool iterate_view(RowView& rv) override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!BatchReader::iterate_view(rv))
+                return false;
+        } while (rv.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(rv, &fns, row_num);
+
+        return true;
+    }
+};
+
+/**
+ * @brief parse csv data from a contiguous buffer owned by the caller
+ *
+ * it shares BaseMIOReader::parse() with MIOReader and nothing is copied before parsing.
+ * the buffer must outlive the reader. for a std::span<const char> sp, pass
+ * std::string_view{sp.data(), sp.size()}.
+ */
+class BufferReader : public BaseMIOReader {
+public:
+    BufferReader() = delete;
+
+    explicit BufferReader(std::string_view sv_, const char delim_ = ',')
+        : BaseReader{}, BaseMIOReader{delim_}
+    {
+        it = sv_.data();
+        it_end = it + sv_.size();
+    }
+};
+
+class BufferDictReader : public BufferReader, public BaseDictReader {
+public:
+    BufferDictReader() = delete;
+
+    explicit BufferDictReader(std::string_view sv_, const Row& fieldnames_ = {},
+                              const char delim_ = ',')
+        : BufferReader{sv_, delim_}, BaseDictReader{}
+    {
+        setup_headers(fieldnames_);
+    }
+
+private:
+    bool iterate() override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!BufferReader::iterate())
+                return false;
+        } while (row.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(row, &fns, row_num);
+
+        return true;
+    }
+
+    bool iterate_view(RowView& rv) override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!BufferReader::iterate_view(rv))
+                return false;
+        } while (rv.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(rv, &fns, row_num);
+
+        return true;
+    }
+};
+
+/**
+ * @brief parse a csv file while it is still being appended to (i.e., tail -f)
+ *
+ * @details on reaching EOF, it polls the file size and maps only the newly appended region.
+ *          a trailing line without '\n' is held back until it is completed so that rows are
+ *          never torn apart.
+ *
+ *          iteration ends once
+ *          1. no complete row is appended for a period of timeout (if it is positive), where
+ *             the line held back, if any, is taken as the last row; or
+ *          2. stop() is called (from another thread), where the line held back, if any, is
+ *             left unread, and get_offset() tells where to resume.
+ *
+ * @note polling is adopted rather than inotify or kqueue for portability.
+ */
+class FollowReader : public BaseMIOReader {
+public:
+    using Duration = std::chrono::milliseconds;
+
+    FollowReader() = delete;
+
+    /**
+     * @param path_ the csv file being appended to. it is fine if it does not exist yet.
+     * @param delim_ a single character delimiter
+     * @param interval_ the polling interval
+     * @param timeout_ the maximum idle period before iteration ends. zero means waiting
+     * until stop() is called.
+     */
+    explicit FollowReader(const std::string& path_, const char delim_ = ',',
+                          Duration interval_ = Duration{100}, Duration timeout_ = Duration{0})
+        : BaseReader{}, BaseMIOReader{delim_}, path {path_}, interval {interval_},
+          timeout {timeout_}
+    {
+    }
+
+    /**
+     * @brief end iteration at the next poll. it is thread-safe.
+     */
+    void stop()
+    {
+        stopped = true;
+    }
+
+    /**
+     * @brief the file offset right after the last row parsed
+     */
+    size_type get_offset() const
+    {
+        return ms.is_mapped() ? offset + (it - ms.begin()) : offset;
+    }
+
+protected:
+    const std::string path;
+    const Duration interval;
+    const Duration timeout;
+
+    std::atomic<bool> stopped {false};
+    // the line held back has been taken as the last row
+    bool expired = false;
+    mio::mmap_source ms;
+    // the file offset of ms.begin()
+    size_type offset = 0;
+
+private:
+    /**
+     * @brief wait for and map the next complete rows
+     *
+     * @return false if iteration ends, true otherwise.
+     */
+    bool refill() override;
+};
+
+class FollowDictReader : public FollowReader, public BaseDictReader {
+public:
+    FollowDictReader() = delete;
+
+    /**
+     * @note it waits for the headers in case that fieldnames_ is empty.
+     */
+    explicit FollowDictReader(const std::string& path_, const Row& fieldnames_ = {},
+                              const char delim_ = ',', Duration interval_ = Duration{100},
+                              Duration timeout_ = Duration{0})
+        : FollowReader{path_, delim_, interval_, timeout_}, BaseDictReader{}
+    {
+        setup_headers(fieldnames_);
+    }
+
+private:
+    bool iterate() override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!FollowReader::iterate())
+                return false;
+        } while (row.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(row, &fns, row_num);
+
+        return true;
+    }
+
+    bool iterate_view(RowView& rv) override
+    {
+        // do not take blank lines
+        do
+        {
+            if (!FollowReader::iterate_view(rv))
+                return false;
+        } while (rv.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(rv, &fns, row_num);
+
+        return true;
+    }
+};
+
+namespace detail
+{
+/**
+ * @brief extend a file to offset + len to be mapped, with the blocks of the extension allocated
+ *
+ * @details writing to the mapping of a sparse file raises SIGBUS once the disk is full. the
+ *          blocks are thus allocated up front via posix_fallocate() on Linux so that it fails
+ *          here instead. elsewhere the file is only resized and the risk remains.
+ *
+ * @return false if the file cannot be extended, e.g., no space left.
+ */
+inline bool extend_file(const std::string& path, size_type offset, size_type len)
+{
+#ifdef __linux__
+    auto fd = ::open(path.c_str(), O_RDWR);
+    if (fd < 0)
+        return false;
+
+    auto err = ::posix_fallocate(fd, static_cast<off_t>(offset), static_cast<off_t>(len));
+    ::close(fd);
+    return !err;
+#else
+    std::error_code ec;
+    std::filesystem::resize_file(path, offset + len, ec);
+    return !ec;
+#endif
+}
+} // namespace detail
+
+/**
+ * @brief a writer that writes to a memory mapped file rather than through a stream, e.g.,
+ *        for large dumps
+ *
+ * @details the file is preallocated and mapped in segments of SEGMENT_SIZE, each of which is
+ *          appended to the file once the previous one is full. the buffered output goes to the
+ *          mapping by a plain memory copy, i.e., no system call per write, and the file is
+ *          truncated to the exact size of the output on close().
+ *
+ * @note std::runtime_error will be thrown if a segment cannot be allocated (see
+ *       detail::extend_file()) or the file cannot be truncated on close().
+ */
+class MMapWriter : public BaseWriter {
+public:
+    // the size of each mapped segment, a multiple of the page size
+    static constexpr size_type SEGMENT_SIZE = 64 << 20;
+
+    MMapWriter() = delete;
+
+    MMapWriter(const std::string& path_, const char delim_ = ',') : BaseWriter{delim_}, path {path_}
+    {
+        setup();
+    }
+
+    MMapWriter(std::string&& path_, const char delim_ = ',') : BaseWriter{delim_}, path {std::move(path_)}
+    {
+        setup();
+    }
+
+    // the destructor of a moved-from one would truncate the file
+    MMapWriter(const MMapWriter&) = delete;
+    MMapWriter& operator=(const MMapWriter&) = delete;
+
+    MMapWriter(MMapWriter&&) = delete;
+    MMapWriter& operator=(MMapWriter&&) = delete;
+
+    ~MMapWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+        }
+    }
+
+    /**
+     * @brief write out the buffered output, unmap the file, and truncate it to the output
+     *
+     * @note nothing can be written after it. the file is truncated to the output written out
+     *       so far even if the rest fails.
+     */
+    void close()
+    {
+        if (closed)
+            return;
+
+        std::exception_ptr failure;
+        try
+        {
+            flush();
+        }
+        catch (...)
+        {
+            failure = std::current_exception();
+            buf.clear();
+        }
+
+        closed = true;
+
+        ms.unmap();
+        std::error_code ec;
+        std::filesystem::resize_file(path, size, ec);
+        if (failure)
+            std::rethrow_exception(failure);
+
+        if (ec)
+            throw std::runtime_error{"MMapWriter: failed to truncate " + path};
+    }
+
+    // the number of chars written out so far
+    size_type get_size() const
+    {
+        return size;
+    }
+
+private:
+    std::string path;
+    mio::mmap_sink ms;
+    // the offset of the mapped segment in the file
+    size_type seg_offset = 0;
+    size_type size = 0;
+    bool closed = false;
+
+    void setup()
+    {
+        std::ofstream ost {path, std::ios::binary | std::ios::trunc};
+        if (!ost)
+        {
+            std::cerr << "invalid input! no " << path << '\n';
+            std::terminate();
+        }
+    }
+
+    // extend the file by a segment and map it
+    void map_segment()
+    {
+        if (ms.is_mapped())
+        {
+            ms.unmap();
+            seg_offset += SEGMENT_SIZE;
+        }
+
+        if (!detail::extend_file(path, seg_offset, SEGMENT_SIZE))
+            throw std::runtime_error{"MMapWriter: failed to extend " + path};
+
+        std::error_code ec;
+        ms.map(path, seg_offset, SEGMENT_SIZE, ec);
+        if (ec)
+        {
+            std::cerr << path << " is not successfully mapped!\n";
+            std::terminate();
+        }
+    }
+
+    void write_out(const char* p, size_type n) override
+    {
+        // the file has been truncated and is not to be extended again
+        if (closed)
+            throw std::runtime_error{"MMapWriter: failed to write to " + path + " as it is closed"};
+
+        while (n)
+        {
+            if (!ms.is_mapped() || size == seg_offset + SEGMENT_SIZE)
+                map_segment();
+
+            auto k = std::min(n, seg_offset + SEGMENT_SIZE - size);
+            std::memcpy(ms.data() + (size - seg_offset), p, k);
+            p += k;
+            n -= k;
+            size += k;
+        }
+    }
+};
+
+namespace detail
+{
+/**
+ * @brief a writer keeping all its output in memory, i.e., a chunk of write_rows_parallel()
+ */
+class ChunkWriter : public BaseWriter {
+public:
+    explicit ChunkWriter(const char delim_) : BaseWriter{delim_}
+    {
+    }
+
+    std::string& get_buffer()
+    {
+        return buf;
+    }
+
+private:
+    void write_out(const char*, size_type) override
+    {
+    }
+
+    // keep buf growing
+    void hand_over() override
+    {
+    }
+};
+} // namespace detail
+
+/**
+ * @brief write a random-access range of rows to a file with the formatting done in parallel,
+ *        where fn(writer, row) writes a row via any of the member functions of BaseWriter, e.g.,
+ *
+ *  write_rows_parallel("link.csv", links, [](miocsv::BaseWriter& w, const Link& link) {
+ *      w.write_row_raw(link.id, link.from, link.to, link.cap);
+ *  });
+ *
+ * @details the rows are formatted in chunks of CHUNK_ROW_NUM, one chunk per thread at a time,
+ *          into buffers of their own. each round of chunks is then copied into the memory
+ *          mapped file in parallel at the prefix sums of their sizes. the output is thus
+ *          byte-identical to that of calling fn on a Writer for the rows in order, while the
+ *          memory is bounded by the chunks of a round.
+ *
+ * @param thread_num the number of threads. zero means all the hardware threads.
+ */
+template<typename Range, typename Fn>
+void write_rows_parallel(const std::string& path, const Range& range, Fn fn, size_type thread_num = 0,
+                         const char delim = ',')
+{
+    static constexpr size_type CHUNK_ROW_NUM = 1 << 16;
+
+    if (!thread_num)
+        thread_num = std::max(1u, std::thread::hardware_concurrency());
+
+    {
+        std::ofstream ost {path, std::ios::binary | std::ios::trunc};
+        if (!ost)
+        {
+            std::cerr << "invalid input! no " << path << '\n';
+            std::terminate();
+        }
+    }
+
+    std::vector<detail::ChunkWriter> writers;
+    writers.reserve(thread_num);
+    for (size_type k = 0; k != thread_num; ++k)
+        writers.emplace_back(delim);
+
+    auto first = std::begin(range);
+    auto n = static_cast<size_type>(std::size(range));
+    size_type size = 0;
+    std::vector<size_type> offsets;
+    for (size_type b = 0; b < n; b += thread_num * CHUNK_ROW_NUM)
+    {
+        auto e = std::min(n, b + thread_num * CHUNK_ROW_NUM);
+        auto m = (e - b + CHUNK_ROW_NUM - 1) / CHUNK_ROW_NUM;
+        parallel_for(m, thread_num, [&](size_type k) {
+            auto& w = writers[k];
+            w.get_buffer().clear();
+            for (auto i = b + k * CHUNK_ROW_NUM, i_end = std::min(e, i + CHUNK_ROW_NUM); i != i_end; ++i)
+                fn(static_cast<BaseWriter&>(w), first[i]);
+        });
+
+        // exclusive prefix sums
+        offsets.assign(1, 0);
+        for (size_type k = 0; k != m; ++k)
+            offsets.push_back(offsets.back() + writers[k].get_buffer().size());
+
+        if (!offsets.back())
+            continue;
+
+        if (!detail::extend_file(path, size, offsets.back()))
+        {
+            std::cerr << path << " cannot be extended!\n";
+            std::terminate();
+        }
+
+        std::error_code ec;
+        mio::mmap_sink ms;
+        ms.map(path, size, offsets.back(), ec);
+        if (ec)
+        {
+            std::cerr << path << " is not successfully mapped!\n";
+            std::terminate();
+        }
+
+        parallel_for(m, thread_num, [&](size_type k) {
+            const auto& buf = writers[k].get_buffer();
+            std::memcpy(ms.data() + offsets[k], buf.data(), buf.size());
+        });
+
+        size += offsets.back();
+    }
+}
+
+template<typename Fn>
+void MultiFileReader::parallel_for_each(Fn fn, size_type thread_num) const
+{
+    auto bases = count_rows(0, thread_num);
+
+    parallel_for(paths.size(), thread_num, [&](size_type i) {
+        if (is_empty(paths[i]))
+            return;
+
+        FilePart fp {paths[i], delim};
+        while (fp.next())
+            fn(static_cast<const Row&>(fp.get_row()), bases[i] + fp.get_row_num());
+    });
+}
+
+template<typename Fn>
+void MultiFileDictReader::parallel_for_each(Fn fn, size_type thread_num) const
+{
+    auto header_num = headers.empty() ? 0 : 1;
+    auto bases = count_rows(header_num, thread_num);
+
+    parallel_for(paths.size(), thread_num, [&](size_type i) {
+        if (is_empty(paths[i]))
+            return;
+
+        FilePart fp {paths[i], delim};
+        while (fp.next())
+        {
+            auto& r = fp.get_row();
+            if (r.empty())
+                continue;
+
+            auto local_row_num = fp.get_row_num();
+            if (header_num && local_row_num == 1)
+            {
+                check_headers(r, i);
+                continue;
+            }
+
+            // the header of the first file is still counted as in iterate()
+            auto n = bases[i] + local_row_num - (i ? header_num : 0);
+            attach_fieldnames(r, &fns, n);
+            fn(static_cast<const Row&>(r), n);
+        }
+    });
+}
+
+std::vector<size_type> MultiFileReader::count_rows(size_type header_num, size_type thread_num) const
+{
+    std::vector<size_type> bases(paths.size(), 0);
+    parallel_for(paths.size(), thread_num, [&](size_type i) {
+        if (is_empty(paths[i]))
+            return;
+
+        FilePart fp {paths[i], delim};
+        auto n = fp.count_rows();
+        bases[i] = i && n >= header_num ? n - header_num : n;
+    });
+
+    // exclusive prefix sums
+    size_type sum = 0;
+    for (auto& b : bases)
+    {
+        auto n = b;
+        b = sum;
+        sum += n;
+    }
+
+    return bases;
+}
+
+bool BatchReader::open(const std::string& path)
+{
+    it = it_end = nullptr;
+    row_num = 0;
+    if (ms.is_mapped())
+        ms.unmap();
+
+    std::error_code ec;
+    auto sz = static_cast<size_type>(std::filesystem::file_size(path, ec));
+    if (ec)
+        return false;
+
+    if (sz && sz >= threshold)
+    {
+        ms.map(path, ec);
+        if (ec)
+            return false;
+
+        it = ms.begin();
+        it_end = ms.end();
+        return true;
+    }
+
+    auto* f = std::fopen(path.c_str(), "rb");
+    if (!f)
+        return false;
+
+    // read it in one go without stdio buffering
+    std::setvbuf(f, nullptr, _IONBF, 0);
+    buf.resize(sz);
+    auto n = std::fread(buf.data(), 1, sz, f);
+    std::fclose(f);
+
+    it = buf.data();
+    it_end = it + n;
+    return true;
+}
+
+bool FollowReader::refill()
+{
+    // hold back the partial line, if any
+    offset = get_offset();
+    if (ms.is_mapped())
+        ms.unmap();
+
+    it = it_end = nullptr;
+    if (expired)
+        return false;
+
+    auto idle_start = std::chrono::steady_clock::now();
+    while (!stopped)
+    {
+        std::error_code ec;
+        auto sz = static_cast<size_type>(std::filesystem::file_size(path, ec));
+        if (ec)
+            sz = 0;
+
+        if (sz < offset)
+        {
+            std::cerr << path << " is truncated!\n";
+            return false;
+        }
+
+        // expired is only set once no complete line is found, so that the partial line is
+        // still delivered by the next refill
+        auto timed_out = timeout.count() > 0
+                         && std::chrono::steady_clock::now() - idle_start >= timeout;
+
+        if (sz > offset)
+        {
+            // map the newly appended region only
+            ms.map(path, offset, sz - offset, ec);
+            if (ec)
+            {
+                std::cerr << path << " is not successfully mapped!\n";
+                return false;
+            }
+
+            auto last = ms.end();
+            while (last != ms.begin() && *(last - 1) != LF)
+                --last;
+
+            it = ms.begin();
+            if (last != ms.begin())
+            {
+                it_end = last;
+                return true;
+            }
+
+            // no more rows will come and the partial line is taken as the last row
+            if (timed_out)
+            {
+                expired = true;
+                it_end = ms.end();
+                return true;
+            }
+
+            ms.unmap();
+            it = nullptr;
+        }
+
+        if (timed_out)
+        {
+            expired = true;
+            return false;
+        }
+
+        std::this_thread::sleep_for(interval);
+    }
+
+    return false;
+}
+
+template<typename R>
+void BaseMIOReader::parse(R& r)
+{
+    auto quoted = false;
+    StringRange<const char*> sr{it};
+
+    // caution: the last line might not be terminated by '\n'. the range is checked first
+    // so that no char beyond it_end is ever read.
+    while (true)
+    {
+        if (semi_branch_expect(it == it_end, false))
+        {
+            // last one
+            if (sr.empty() || sr.back() != CR)
+                r.append(sr.to_string_view());
+            else
+                r.append(sr.to_string_view_cr());
+
+            return;
+        }
+        else if (*it == quote)
         {
             sr.extend(++it);
             quoted ^= true;
 #ifdef FORMAT_CHECKER
-            if (!quoted && *it != quote && *it != delim && *it != CR && *it != LF)
+            if (!quoted && it != it_end && *it != quote && *it != delim && *it != CR && *it != LF)
             {
                 std::cerr << "CAUTION: Invalid Row at line " << row_num + 1
                           << "! Value is not allowed after quoted field: "
-                          << sr.to_string() << ".\n";
+                          << sr.to_string_view() << ".\n";
 #ifdef CUT_BAD_FIELDS
                 std::cerr << "\t Invalid fields are discarded!\n";
                 // "it" may have reached EOF
-                it = std::find(it, ms.end(), LF);
+                it = std::find(it, it_end, LF);
 #endif  // CUT_BAD_FIELDS
             }
 #endif  // FORMAT_CHECKER
         }
         else if (*it == delim && !quoted)
         {
-            r.append(sr.to_string());
+            r.append(sr.to_string_view());
             sr.reset(++it);
         }
         else if (*it == LF)
         {
             // last one
-            if (sr.back() != CR)
-                r.append(sr.to_string());
+            if (sr.empty() || sr.back() != CR)
+                r.append(sr.to_string_view());
             else
-                r.append(sr.to_string_cr());
+                r.append(sr.to_string_view_cr());
 
             ++it;
-            return r;
+            return;
         }
-        else if (semi_branch_expect(it == ms.end(), true))
-            return r;
         else
             sr.extend(++it);
     }
@@ -16,7 +16,7 @@
  *          otherwise, an O(5N) implementation (i.e., Reader::split2()) will be in place.
  *
  * @remark  it does not apply to MIOReader and MIODictReader as they only have one parsing function,
- *          which is MIOReader::parse() bounded by O(3N).
+ *          which is BaseMIOReader::parse() bounded by O(3N).
  */
 #define O3N_TIME_BOUND
 
@@ -46,773 +46,2631 @@
 // #define CUT_BAD_FIELDS
 
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <initializer_list>
 #include <iostream>
-#include <map>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
 #include <sstream>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace miocsv
 {
 using size_type = unsigned long;
-using FieldNames = std::map<std::string, size_type>;
 
 /**
- * @brief a helper class to define a string range by [head, tail]
+ * @brief map fieldnames (headers) to their indices
  *
- * it is to mimic std::string_view but with capability in changing head and tail.
- * we use it to avoid potential dynamic memory allocation (and deallocation) and
- * copy in string concatenation.
+ * it is a flat open-addressing hash table with fieldnames stored in their insertion order,
+ * which replaces std::map<std::string, size_type>. a lookup is one hash over the name and
+ * (mostly) one string comparison rather than O(log C) string comparisons, and it takes
+ * std::string_view directly so that no std::string is constructed from a string literal.
  */
-template <typename InputIter>
-class StringRange {
+class FieldNames {
 public:
-    StringRange() = delete;
+    using value_type = std::pair<std::string, size_type>;
+    using const_iterator = std::vector<value_type>::const_iterator;
 
-    explicit StringRange(InputIter it) : head {it}, tail {it}
+    static constexpr size_type npos = static_cast<size_type>(-1);
+
+    FieldNames() = default;
+
+    /**
+     * @brief retrieve the index of a fieldname, which is inserted if nonexistent
+     *
+     * @note it keeps fns[s] = i from std::map working.
+     */
+    size_type& operator[](std::string_view s)
     {
+        auto slot = probe(s);
+        if (!slots[slot])
+        {
+            names.emplace_back(std::string{s}, npos);
+            slots[slot] = static_cast<std::uint32_t>(names.size());
+            // keep the load factor no greater than 0.5
+            if (names.size() * 2 > slots.size())
+                rehash(slots.size() * 2);
+
+            return names.back().second;
+        }
+
+        return names[slots[slot] - 1].second;
     }
 
-    StringRange(const StringRange&) = delete;
-    StringRange& operator=(const StringRange&) = delete;
+    /**
+     * @brief retrieve the index of a fieldname
+     *
+     * @return npos if it is nonexistent
+     */
+    size_type find(std::string_view s) const noexcept
+    {
+        if (names.empty())
+            return npos;
 
-    StringRange(StringRange&&) = delete;
-    StringRange& operator=(StringRange&&) = delete;
+        auto slot = slots[probe(s)];
+        return slot ? names[slot - 1].second : npos;
+    }
 
-    ~StringRange() = default;
+    // throw std::out_of_range as std::map::at() if it is nonexistent
+    size_type at(std::string_view s) const
+    {
+        auto i = find(s);
+        if (i == npos)
+            throw std::out_of_range{"FieldNames::at: " + std::string{s} + " is nonexistent"};
 
-    char back() const
+        return i;
+    }
+
+    bool contains(std::string_view s) const noexcept
     {
-        return *(tail - 1);
+        return find(s) != npos;
     }
 
-    bool empty() const
+    // in the insertion order
+    const_iterator begin() const
     {
-        return tail == head;
+        return names.begin();
     }
 
-    void extend(InputIter it)
+    const_iterator end() const
     {
-        // check it > tail?
-        tail = it;
+        return names.end();
     }
 
-    void reset(InputIter it)
+    size_type size() const
     {
-        head = tail = it;
+        return names.size();
     }
 
-    std::string to_string() const
+    bool empty() const
     {
-        return std::string{head, tail};
+        return names.empty();
     }
 
-    // in case that the last char is '\r'
-    std::string to_string_cr() const
+    void clear()
     {
-        return std::string{head, tail - 1};
+        names.clear();
+        slots.assign(MIN_SLOT_NUM, 0);
     }
 
 private:
-    InputIter head;
-    InputIter tail;
-};
+    static constexpr size_type MIN_SLOT_NUM = 16;
 
-/**
- * @brief a custom exception which arises when a nonexistent field is retrieved
- * via Row::[] (i.e., no such a field in the header)
- */
-struct NoRecord : public std::runtime_error {
-    NoRecord() = delete;
+    std::vector<value_type> names;
+    // 1-based indices into names, where 0 indicates an empty slot
+    std::vector<std::uint32_t> slots = std::vector<std::uint32_t>(MIN_SLOT_NUM, 0);
 
-    explicit NoRecord(const std::string& s)
-        : std::runtime_error{"Row::operator[]: " + s + " is nonexistent"}
+    // FNV-1a, which is good enough for short strings like fieldnames
+    static size_type hash(std::string_view s) noexcept
     {
+        std::uint64_t h = 14695981039346656037ull;
+        for (auto c : s)
+        {
+            h ^= static_cast<unsigned char>(c);
+            h *= 1099511628211ull;
+        }
+
+        return static_cast<size_type>(h);
     }
 
-    explicit NoRecord(size_type s)
-        : std::runtime_error{"Row::operator[]: " + std::to_string(s) + " is out of range"}
+    // linear probing until s or an empty slot is found
+    size_type probe(std::string_view s) const noexcept
     {
+        auto mask = slots.size() - 1;
+        auto slot = hash(s) & mask;
+        while (slots[slot] && names[slots[slot] - 1].first != s)
+            slot = (slot + 1) & mask;
+
+        return slot;
     }
-};
 
-class Row {
-    friend void attach_fieldnames(Row&, const FieldNames*, size_type);
-    friend std::ostream& operator<<(std::ostream&, const Row&);
+    void rehash(size_type n)
+    {
+        slots.assign(n, 0);
+        for (size_type i = 0, sz = names.size(); i != sz; ++i)
+        {
+            auto slot = hash(names[i].first) & (n - 1);
+            while (slots[slot])
+                slot = (slot + 1) & (n - 1);
 
-public:
-    using Records = std::vector<std::string>;
-    using iterator = Records::iterator;
-    using const_iterator = Records::const_iterator;
+            slots[slot] = static_cast<std::uint32_t>(i + 1);
+        }
+    }
+};
 
-    Row() = default;
+/**
+ * @brief a fieldname resolved to its index ahead of time via DictReader::column()
+ *
+ * retrieving a field through it is as fast as through an index, e.g.,
+ *
+ *  auto link_id = reader.column("link_id");
+ *  for (const auto& line : reader)
+ *      std::cout << line[link_id] << '\n';
+ */
+class Column {
+public:
+    Column() = default;
 
-    // pure string input
-    Row(std::initializer_list<std::string> args)
+    explicit Column(size_type i) : index {i}
     {
-        for (auto& s: args)
-            records.emplace_back(s);
     }
 
-    template<typename T, typename... Args>
-    Row(const T& t, const Args&... args)
+    size_type get_index() const
     {
-        convert_to_string(t, args...);
+        return index;
     }
 
-    Row(Records&& r)
+    bool valid() const
     {
-        records = r;
+        return index != FieldNames::npos;
     }
 
-    Row(const Row&) = default;
-    Row& operator=(const Row&) = delete;
-
-    Row(Row&&) = default;
-    Row& operator=(Row&&) = default;
+private:
+    size_type index = FieldNames::npos;
+};
 
-    ~Row() = default;
+/**
+ * @brief map distinct strings to consecutive integer codes in the order of their first
+ *        appearance, i.e., dictionary encoding
+ *
+ * @details it is built on the same flat hash table as FieldNames. a low-cardinality column
+ *          (e.g., facility_type) is then stored as one code per row plus a single copy of each
+ *          distinct value, and comparisons between rows become integer comparisons, e.g.,
+ *
+ *  Dictionary dict;
+ *  std::vector<Dictionary::code_type> codes;
+ *  for (const auto& line : reader)
+ *      codes.push_back(dict.encode(line["facility_type"]));
+ */
+class Dictionary {
+public:
+    using code_type = std::uint32_t;
 
-    std::string& operator[](size_type i)
-    {
-        if (i >= records.size())
-            throw NoRecord{i};
+    static constexpr code_type npos = static_cast<code_type>(-1);
 
-        return records[i];
-    }
+    Dictionary() = default;
 
-    const std::string& operator[](size_type i) const
+    // retrieve the code of s, which is appended if s is new
+    code_type encode(std::string_view s)
     {
-        if (i >= records.size())
-            throw NoRecord{i};
+        auto& c = values[s];
+        if (c == FieldNames::npos)
+            c = values.size() - 1;
 
-        return records[i];
+        return static_cast<code_type>(c);
     }
 
-    // use std::runtime_error?
-    std::string& operator[](const std::string& s)
+    // return npos if s is nonexistent
+    code_type find(std::string_view s) const noexcept
     {
-        try
-        {
-            size_type i = fns->at(s);
-            // more fieldnames than fields will be taken care by operator[]
-            return records[i];
-        }
-        catch (const std::out_of_range)
-        {
-            throw NoRecord{s};
-        }
+        auto c = values.find(s);
+        return c == FieldNames::npos ? npos : static_cast<code_type>(c);
     }
 
-    /**
-     * @brief retrieve a field (record) using fieldname (header)
-     *
-     * in case of data inconsistency, the following two cases are considered.
-     *
-     * 1. if there are more fields than fieldnames, users can only retrieve those
-     * extra fields (with no corresponding fieldnames) using indices via overloaded
-     * [].
-     * 2. if there are more fieldnames than fields, an exception NoRecord will be
-     * thrown at run time.
-     *
-     * Note that our way handling these two exceptions are different with Python
-     * csv.DictReader, where, extra fields will be concatenated as a list
-     * (of strings) with None assigned as a new fieldname for case 1; None will
-     * be output for case 2.
-     *
-     * @param s
-     * @return const std::string&
-     */
-    const std::string& operator[](const std::string& s) const
+    // no bounds checking
+    const std::string& operator[](code_type c) const
     {
-        try
-        {
-            size_type i = fns->at(s);
-            // more fieldnames than fields will be taken care by operator[]
-            return records[i];
-        }
-        catch (const std::out_of_range)
-        {
-            throw NoRecord{s};
-        }
+        return (values.begin() + c)->first;
     }
 
-    std::string& back()
+    const std::string& decode(code_type c) const
     {
-        return records.back();
-    }
+        if (c >= values.size())
+            throw std::out_of_range{"Dictionary::decode: " + std::to_string(c) + " is out of range"};
 
-    const std::string& back() const
-    {
-        return records.back();
+        return (*this)[c];
     }
 
-    iterator begin()
+    size_type size() const
     {
-        return records.begin();
+        return values.size();
     }
 
-    const_iterator begin() const
+    bool empty() const
     {
-        return records.begin();
+        return values.empty();
     }
 
-    iterator end()
+    void clear()
     {
-        return records.end();
+        values.clear();
     }
 
-    const_iterator end() const
+private:
+    FieldNames values;
+};
+
+/**
+ * @brief a helper class to define a string range by [head, tail]
+ *
+ * it is to mimic std::string_view but with capability in changing head and tail.
+ * we use it to avoid potential dynamic memory allocation (and deallocation) and
+ * copy in string concatenation.
+ */
+template <typename InputIter>
+class StringRange {
+public:
+    StringRange() = delete;
+
+    explicit StringRange(InputIter it) : head {it}, tail {it}
     {
-        return records.end();
     }
 
-    size_type size() const
+    StringRange(const StringRange&) = delete;
+    StringRange& operator=(const StringRange&) = delete;
+
+    StringRange(StringRange&&) = delete;
+    StringRange& operator=(StringRange&&) = delete;
+
+    ~StringRange() = default;
+
+    char back() const
     {
-        return records.size();
+        return *(tail - 1);
     }
 
     bool empty() const
     {
-        return records.size() == 0;
+        return tail == head;
     }
 
-    // move non-const string
-    void append(std::string& s)
+    void extend(InputIter it)
     {
-        records.emplace_back(s);
+        // check it > tail?
+        tail = it;
     }
 
-    // move rvalue string
-    void append(std::string&& s)
+    void reset(InputIter it)
     {
-        records.push_back(s);
+        head = tail = it;
     }
 
-    // copy const string with no move
-    void append(const std::string& s)
+    std::string to_string() const
     {
-        records.push_back(s);
+        return std::string{head, tail};
     }
 
-    void append(const std::string_view sv)
+    // in case that the last char is '\r'
+    std::string to_string_cr() const
     {
-        records.push_back(std::string{sv});
+        return std::string{head, tail - 1};
     }
 
-private:
-    Records records;
-    // reserved for DictReader
-    const FieldNames* fns = nullptr;
-
-    template<typename T>
-    void convert_to_string(const T& t)
+    // only applicable to contiguous chars, e.g., const char*
+    std::string_view to_string_view() const
     {
-        std::ostringstream os;
-        os << t;
-        // os.str() will be moved into records as os.str() is a rvalue reference
-        records.push_back(os.str());
+        return std::string_view{&*head, static_cast<std::size_t>(tail - head)};
     }
 
-    template<typename T, typename... Args>
-    void convert_to_string(const T& t, const Args&... args)
+    std::string_view to_string_view_cr() const
     {
-#if __cplusplus >= 201703L
-        std::ostringstream os;
-        os << t;
-        records.push_back(os.str());
-        // it requires C++17
-        if constexpr(sizeof...(args) > 0)
-            convert_to_string(args...);
-#else
-        convert_to_string(t);
-        convert_to_string(args...);
-#endif
+        return std::string_view{&*head, static_cast<std::size_t>(tail - head - 1)};
     }
+
+private:
+    InputIter head;
+    InputIter tail;
 };
 
-// not a pure abstract class
-class BaseReader {
-public:
-    BaseReader() : quote {'"'}, row_num {0}
-    {
-    }
+namespace detail
+{
+// check if all the eight chars of x are digits
+constexpr bool is_digits_swar(std::uint64_t x)
+{
+    return ((x & 0xF0F0F0F0F0F0F0F0) | (((x + 0x0606060606060606) & 0xF0F0F0F0F0F0F0F0) >> 4))
+           == 0x3333333333333333;
+}
 
-    BaseReader(const BaseReader&) = delete;
-    BaseReader& operator=(const BaseReader&) = delete;
+// accumulate the eight digits of x, the first one in the lowest byte
+constexpr std::uint64_t digits_swar(std::uint64_t x)
+{
+    x = (x & 0x0F0F0F0F0F0F0F0F) * 2561 >> 8;
+    x = (x & 0x00FF00FF00FF00FF) * 6553601 >> 16;
+    return static_cast<std::uint32_t>((x & 0x0000FFFF0000FFFF) * 42949672960001 >> 32);
+}
 
-    BaseReader(BaseReader&&) = default;
-    BaseReader& operator=(BaseReader&&) = delete;
+/**
+ * @brief parse up to eight digits at once using SWAR (SIMD within a register)
+ *
+ * @details the digits are right aligned in a 64-bit word padded with '0' so that they are
+ *          validated and accumulated by a handful of integer operations rather than a loop
+ *          over chars. see https://lemire.me/blog/2022/01/21/swar-explained-parsing-eight-digits/.
+ *
+ * @note it requires a little-endian platform.
+ *
+ * @return false if any char is not a digit.
+ */
+inline bool parse_digits_swar(const char* p, std::size_t n, std::uint64_t& u)
+{
+    std::uint64_t x = 0x3030303030303030;
+    std::memcpy(reinterpret_cast<char*>(&x) + 8 - n, p, n);
 
-    virtual ~BaseReader()
+    if (!is_digits_swar(x))
+        return false;
+
+    u = digits_swar(x);
+    return true;
+}
+
+// load eight chars with the first one in the lowest byte regardless of the platform
+inline std::uint64_t load_le(const char* p)
+{
+    std::uint64_t x;
+    std::memcpy(&x, p, 8);
+    if constexpr (std::endian::native == std::endian::big)
     {
+        std::uint64_t y = 0;
+        for (auto i = 0; i != 8; ++i, x >>= 8)
+            y = y << 8 | (x & 0xFF);
+
+        x = y;
     }
 
-    // forward declaration
-    class ReaderIterator;
+    return x;
+}
+
+// set the highest bit of the first byte of x equal to c, and maybe some following ones
+constexpr std::uint64_t match_byte_swar(std::uint64_t x, char c)
+{
+    x ^= 0x0101010101010101 * static_cast<unsigned char>(c);
+    return (x - 0x0101010101010101) & ~x & 0x8080808080808080;
+}
+
+/**
+ * @brief check if s contains delim, '"', CR, or LF, i.e., it has to be quoted in a csv file
+ *
+ * @details all the four are looked for together eight chars at a time via SWAR. the last
+ *          few chars are padded with the first of them, which does not change the result.
+ */
+inline bool needs_quoting(std::string_view s, const char delim)
+{
+    auto match = [delim](std::uint64_t x) {
+        return match_byte_swar(x, delim) | match_byte_swar(x, '"') | match_byte_swar(x, '\r')
+               | match_byte_swar(x, '\n');
+    };
+
+    const char* p = s.data();
+    auto n = s.size();
+    for (; n >= 8; p += 8, n -= 8)
+    {
+        std::uint64_t x;
+        std::memcpy(&x, p, 8);
+        if (match(x))
+            return true;
+    }
+
+    if (!n)
+        return false;
+
+    std::uint64_t x = 0x0101010101010101 * static_cast<unsigned char>(*p);
+    std::memcpy(&x, p, n);
+    return match(x);
+}
+
+template<typename T, typename = void>
+struct is_tuple_like : std::false_type {};
+
+template<typename T>
+struct is_tuple_like<T, std::void_t<decltype(std::tuple_size<T>::value)>> : std::true_type {};
+
+template<typename T>
+struct is_sys_time : std::false_type {};
+
+template<typename Duration>
+struct is_sys_time<std::chrono::sys_time<Duration>> : std::true_type {};
+
+template<typename T>
+bool from_chars_exact(const char* b, const char* e, T& t)
+{
+    // std::from_chars() does not take a leading '+'
+    if (b != e && *b == '+' && e - b > 1 && b[1] != '-')
+        ++b;
+
+    T v;
+    auto [p, ec] = std::from_chars(b, e, v);
+    if (ec != std::errc{} || p != e)
+        return false;
+
+    t = v;
+    return true;
+}
+} // namespace detail
+
+/**
+ * @brief convert [b, e) into an integer
+ *
+ * @details integers of no more than 16 digits (i.e., the vast majority in practice) are
+ *          parsed via SWAR. others fall back to std::from_chars.
+ *
+ * @return false if [b, e) is not an integer in the range of T, where t is untouched.
+ */
+template<typename T>
+bool parse_integer(const char* b, const char* e, T& t)
+{
+    const char* p = b;
+    auto neg = false;
+    if (p != e && (*p == '-' || *p == '+'))
+        neg = *p++ == '-';
+
+    auto n = static_cast<std::size_t>(e - p);
+    if (!n || n > 16 || std::endian::native != std::endian::little || (neg && std::is_unsigned_v<T>))
+        return detail::from_chars_exact(b, e, t);
+
+    std::uint64_t u;
+    if (n <= 8)
+    {
+        if (!detail::parse_digits_swar(p, n, u))
+            return false;
+    }
+    else
+    {
+        std::uint64_t hi, lo;
+        if (!detail::parse_digits_swar(p, n - 8, hi) || !detail::parse_digits_swar(p + n - 8, 8, lo))
+            return false;
+
+        u = hi * 100000000 + lo;
+    }
+
+    // u < 10^16 fits in std::int64_t
+    auto v = neg ? -static_cast<std::int64_t>(u) : static_cast<std::int64_t>(u);
+    if constexpr (std::is_signed_v<T>)
+    {
+        if (v < static_cast<std::int64_t>(std::numeric_limits<T>::min())
+            || v > static_cast<std::int64_t>(std::numeric_limits<T>::max()))
+            return false;
+    }
+    else
+    {
+        if (u > static_cast<std::uint64_t>(std::numeric_limits<T>::max()))
+            return false;
+    }
+
+    t = static_cast<T>(v);
+    return true;
+}
+
+/**
+ * @brief convert [b, e) into a floating-point number
+ *
+ * @details it takes the fast path by Clinger (1990) if the decimal significand has no more
+ *          than 19 digits and is exactly representable in T (i.e., no more than 2^53 for
+ *          double), and the decimal exponent is small enough (i.e., 10^|e| is exact in T).
+ *          the result is then a single correctly-rounded multiplication or division. others,
+ *          including nan and inf, fall back to std::from_chars, which is correctly rounded.
+ *
+ * @return false if [b, e) is not a floating-point number, where t is untouched.
+ */
+template<typename T>
+bool parse_float(const char* b, const char* e, T& t)
+{
+    if constexpr (!std::is_same_v<T, double> && !std::is_same_v<T, float>)
+        return detail::from_chars_exact(b, e, t);
+    else
+    {
+        static constexpr T POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                      1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                      1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+        // the largest exact power of 10 and integer
+        static constexpr int MAX_EXP = std::is_same_v<T, double> ? 22 : 10;
+        static constexpr std::uint64_t MAX_SIG = std::uint64_t{1} << std::numeric_limits<T>::digits;
+
+        const char* p = b;
+        auto neg = false;
+        if (p != e && (*p == '-' || *p == '+'))
+            neg = *p++ == '-';
+
+        std::uint64_t m = 0;
+        // significant digits taken, exclusive of leading zeros
+        int n = 0;
+        int exp10 = 0;
+
+        const char* q = p;
+        for (; p != e && static_cast<unsigned>(*p - '0') < 10; ++p)
+        {
+            m = m * 10 + static_cast<unsigned>(*p - '0');
+            n += m != 0;
+        }
+
+        auto digit_num = p - q;
+        if (p != e && *p == '.')
+        {
+            q = ++p;
+            for (; p != e && static_cast<unsigned>(*p - '0') < 10; ++p)
+            {
+                m = m * 10 + static_cast<unsigned>(*p - '0');
+                n += m != 0;
+                --exp10;
+            }
+
+            digit_num += p - q;
+        }
+
+        // e.g., nan and inf
+        if (!digit_num)
+            return detail::from_chars_exact(b, e, t);
+
+        if (p != e && (*p | 0x20) == 'e')
+        {
+            auto exp_neg = false;
+            if (++p != e && (*p == '-' || *p == '+'))
+                exp_neg = *p++ == '-';
+
+            q = p;
+            int x = 0;
+            for (; p != e && static_cast<unsigned>(*p - '0') < 10 && x < 10000; ++p)
+                x = x * 10 + (*p - '0');
+
+            if (p == q)
+                return false;
+
+            exp10 += exp_neg ? -x : x;
+        }
+
+        if (p != e || n > 19)
+            return detail::from_chars_exact(b, e, t);
+
+        if (!m)
+        {
+            t = neg ? -T{0} : T{0};
+            return true;
+        }
+
+        if (m > MAX_SIG || exp10 < -MAX_EXP || exp10 > MAX_EXP)
+            return detail::from_chars_exact(b, e, t);
+
+        auto v = static_cast<T>(m);
+        v = exp10 < 0 ? v / POW10[-exp10] : v * POW10[exp10];
+        t = neg ? -v : v;
+        return true;
+    }
+}
+
+/**
+ * @brief convert an ISO 8601 date (YYYY-MM-DD) or date and time (YYYY-MM-DDTHH:MM[:SS[.fff]])
+ *        in [b, e) into a time point since the Unix epoch
+ *
+ * @details a space is also taken in place of 'T', and so is ',' in place of '.'. up to nine
+ *          fractional digits are kept. a trailing Z or UTC offset (i.e., +HH, +HHMM, or +HH:MM)
+ *          is applied. otherwise, it is taken as UTC.
+ *
+ *          the fixed-width part is validated and decoded eight chars at a time via SWAR,
+ *          e.g., "YYYY-MM-" becomes the number YYYY0MM0 once the separators are replaced
+ *          by '0'. the calendar date is then checked (e.g., no Feb 29 in 2021) and counted
+ *          in days via std::chrono::sys_days.
+ *
+ * @note the result is rounded down to Duration, e.g., std::chrono::sys_days drops the time.
+ *
+ * @return false if [b, e) is ill-formed or not a valid date and time, where t is untouched.
+ */
+template<typename Duration>
+bool parse_datetime(const char* b, const char* e, std::chrono::sys_time<Duration>& t)
+{
+    using namespace std::chrono;
+
+    // bytes 4 and 7 of "YYYY-MM-", and bytes 2 and 5 of "DDTHH:MM"
+    static constexpr std::uint64_t DATE_SEPS = 0xFF0000FF00000000;
+    static constexpr std::uint64_t TIME_SEPS = 0x0000FF0000FF0000;
+    static constexpr std::uint64_t ZEROS = 0x3030303030303030;
+
+    auto n = static_cast<std::size_t>(e - b);
+    if (n != 10 && n < 16)
+        return false;
+
+    auto x = detail::load_le(b);
+    if ((x & DATE_SEPS) != (0x2D2D2D2D2D2D2D2D & DATE_SEPS))
+        return false;
+
+    x = (x & ~DATE_SEPS) | (ZEROS & DATE_SEPS);
+    if (!detail::is_digits_swar(x))
+        return false;
+
+    auto ym = detail::digits_swar(x);
+    auto year = static_cast<int>(ym / 10000);
+    auto month = static_cast<unsigned>(ym % 10000 / 10);
+
+    unsigned day = 0, hour = 0, minute = 0, second = 0;
+    std::uint64_t frac = 0;
+    minutes offset {0};
+    if (n == 10)
+    {
+        if (static_cast<unsigned>(b[8] - '0') > 9 || static_cast<unsigned>(b[9] - '0') > 9)
+            return false;
+
+        day = static_cast<unsigned>((b[8] - '0') * 10 + b[9] - '0');
+    }
+    else
+    {
+        x = detail::load_le(b + 8);
+        if ((b[10] != 'T' && b[10] != ' ') || b[13] != ':')
+            return false;
+
+        x = (x & ~TIME_SEPS) | (ZEROS & TIME_SEPS);
+        if (!detail::is_digits_swar(x))
+            return false;
+
+        // DD0HH0MM
+        auto dhm = detail::digits_swar(x);
+        day = static_cast<unsigned>(dhm / 1000000);
+        hour = static_cast<unsigned>(dhm / 1000 % 1000);
+        minute = static_cast<unsigned>(dhm % 1000);
+
+        auto digit = [](char c) { return static_cast<unsigned>(c - '0') < 10; };
+
+        const char* p = b + 16;
+        if (p != e && *p == ':')
+        {
+            if (e - p < 3 || !digit(p[1]) || !digit(p[2]))
+                return false;
+
+            second = static_cast<unsigned>((p[1] - '0') * 10 + p[2] - '0');
+            p += 3;
+
+            if (p != e && (*p == '.' || *p == ','))
+            {
+                const char* q = ++p;
+                // nanoseconds
+                std::uint64_t scale = 100000000;
+                for (; p != e && digit(*p); ++p, scale /= 10)
+                    frac += static_cast<unsigned>(*p - '0') * scale;
+
+                if (p == q)
+                    return false;
+            }
+        }
+
+        if (p != e && *p == 'Z')
+            ++p;
+        else if (p != e && (*p == '+' || *p == '-'))
+        {
+            auto sign = *p == '-' ? -1 : 1;
+            if (e - p < 3 || !digit(p[1]) || !digit(p[2]))
+                return false;
+
+            auto oh = (p[1] - '0') * 10 + p[2] - '0';
+            auto om = 0;
+            p += 3;
+            if (p != e)
+            {
+                p += *p == ':';
+                if (e - p != 2 || !digit(p[0]) || !digit(p[1]))
+                    return false;
+
+                om = (p[0] - '0') * 10 + p[1] - '0';
+                p += 2;
+            }
+
+            if (oh > 23 || om > 59)
+                return false;
+
+            offset = minutes {sign * (oh * 60 + om)};
+        }
+
+        // 60 for a leap second
+        if (p != e || hour > 23 || minute > 59 || second > 60)
+            return false;
+    }
+
+    year_month_day ymd {std::chrono::year {year}, std::chrono::month {month}, std::chrono::day {day}};
+    if (!ymd.ok())
+        return false;
+
+    auto secs = sys_seconds {sys_days {ymd}} + hours {hour} + minutes {minute} + seconds {second} - offset;
+    t = floor<Duration>(secs) + floor<Duration>(nanoseconds {frac});
+    return true;
+}
+
+/**
+ * @brief strip the enclosing double quotes of a field, if any
+ */
+inline std::string_view unquote(std::string_view sv)
+{
+    if (sv.size() >= 2 && sv.front() == '"' && sv.back() == '"')
+        return sv.substr(1, sv.size() - 2);
+
+    return sv;
+}
+
+/**
+ * @brief convert a field into a value of type T directly from its chars
+ *
+ * @details arithmetic types are converted via parse_integer() and parse_float(), time points
+ *          (i.e., std::chrono::sys_time) via parse_datetime(), bool takes true/false (in any
+ *          case) or 1/0, and std::string gets the field with its enclosing double quotes
+ *          removed and "" unescaped.
+ *
+ * @return false if the field is empty or ill-formed for T, where t is untouched. it is always
+ *         true for std::string and std::string_view, which take an empty field as it is.
+ */
+template<typename T>
+bool from_field(std::string_view sv, T& t)
+{
+    auto quoted = sv.size() >= 2 && sv.front() == '"' && sv.back() == '"';
+    if (quoted)
+        sv = sv.substr(1, sv.size() - 2);
+
+    if constexpr (std::is_same_v<T, std::string>)
+    {
+        t.assign(sv);
+        if (quoted)
+        {
+            // "" stands for " in a quoted field
+            for (auto i = t.find("\"\""); i != std::string::npos; i = t.find("\"\"", i + 1))
+                t.erase(i, 1);
+        }
+
+        return true;
+    }
+    else if constexpr (std::is_same_v<T, std::string_view>)
+    {
+        t = sv;
+        return true;
+    }
+    else if constexpr (std::is_same_v<T, bool>)
+    {
+        auto iequal = [](std::string_view a, std::string_view b) {
+            return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](char x, char y) {
+                return (x | 0x20) == y;
+            });
+        };
+
+        if (sv == "1" || iequal(sv, "true"))
+            t = true;
+        else if (sv == "0" || iequal(sv, "false"))
+            t = false;
+        else
+            return false;
+
+        return true;
+    }
+    else if constexpr (detail::is_sys_time<T>::value)
+        return parse_datetime(sv.data(), sv.data() + sv.size(), t);
+    else if constexpr (std::is_integral_v<T>)
+        return parse_integer(sv.data(), sv.data() + sv.size(), t);
+    else
+    {
+        static_assert(std::is_floating_point_v<T>, "from_field() does not support this type");
+        return parse_float(sv.data(), sv.data() + sv.size(), t);
+    }
+}
+
+/**
+ * @brief decode a batch of fields from the same numeric column into values of type T
+ *
+ * @details it works in three passes over up to BATCH_SIZE fields at a time. the first one
+ *          strips the quotes, the sign, and the exponent of each field, and right aligns its
+ *          digits (with the decimal point removed) in two 64-bit words padded with '0'. the second one
+ *          validates and accumulates all the staged words together via SWAR. it is free of
+ *          branches and runs over plain arrays so that compilers are able to vectorize it.
+ *          the last one applies signs and decimal exponents. fields with more than 16 digits
+ *          or in any other format (e.g., hex, nan, and inf) fall back to from_field().
+ *
+ * @note values shall hold no less than fields.size() elements. fields that cannot be
+ *       converted are set to T{}.
+ *
+ * @return the number of fields that cannot be converted.
+ */
+template<typename T>
+size_type decode_column(std::span<const std::string_view> fields, T* values)
+{
+    static_assert(std::is_arithmetic_v<T> && !std::is_same_v<T, bool>,
+                  "decode_column() only supports numeric types");
+
+    static constexpr size_type BATCH_SIZE = 256;
+    // the largest decimal exponent taken by the fast path (i.e., 10^EXP_MAX is exact in T)
+    static constexpr int EXP_MAX = std::is_same_v<T, float> ? 10 : 22;
+    static constexpr std::uint64_t ZEROS = 0x3030303030303030;
+    static constexpr std::uint64_t SIG_MAX = std::is_floating_point_v<T>
+                                                 ? std::uint64_t{1} << std::numeric_limits<T>::digits
+                                                 : std::numeric_limits<std::uint64_t>::max();
+
+    using F = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+    static constexpr F POW10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                  1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                  1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    std::uint64_t hi[BATCH_SIZE];
+    std::uint64_t lo[BATCH_SIZE];
+    std::uint64_t sig[BATCH_SIZE];
+    unsigned char valid[BATCH_SIZE];
+    signed char exp10[BATCH_SIZE];
+    bool neg[BATCH_SIZE];
+    bool fast[BATCH_SIZE];
+
+    size_type failure_num = 0;
+    for (size_type k = 0, sz = fields.size(); k < sz; k += BATCH_SIZE)
+    {
+        auto m = std::min(BATCH_SIZE, sz - k);
+
+        // pass 1: stage the digits
+        for (size_type i = 0; i != m; ++i)
+        {
+            auto sv = unquote(fields[k + i]);
+            neg[i] = false;
+            exp10[i] = 0;
+
+            if (!sv.empty() && (sv.front() == '-' || sv.front() == '+'))
+            {
+                neg[i] = sv.front() == '-';
+                sv.remove_prefix(1);
+            }
+
+            auto ok = std::endian::native == std::endian::little && !(neg[i] && std::is_unsigned_v<T>);
+            int x = 0;
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                // a short exponent (i.e., e-22 to e+22) at the end
+                for (auto j = sv.size(), j_end = j > 5 ? j - 5 : 0; j-- > j_end;)
+                {
+                    if ((sv[j] | 0x20) == 'e')
+                    {
+                        ok = ok && detail::from_chars_exact(sv.data() + j + 1, sv.data() + sv.size(), x);
+                        sv = sv.substr(0, j);
+                        break;
+                    }
+                }
+            }
+
+            // copy the digits backward so that they are right aligned in the last 16 bytes. it
+            // is kept free of branches as the position of the decimal point varies. any char
+            // other than digits, including a second decimal point, fails the validation.
+            char digits[24];
+            std::memcpy(digits, &ZEROS, 8);
+            std::memcpy(digits + 8, &ZEROS, 8);
+            std::memcpy(digits + 16, &ZEROS, 8);
+
+            auto* q = digits + 24;
+            size_type frac = 0;
+            auto point = false;
+            ok = ok && sv.size() <= 17;
+            for (auto j = ok ? sv.size() : 0; j-- > 0;)
+            {
+                auto skip = std::is_floating_point_v<T> & (sv[j] == '.') & !point;
+                frac = skip ? sv.size() - j - 1 : frac;
+                point |= skip;
+                *--q = sv[j];
+                q += skip;
+            }
+
+            x -= static_cast<int>(frac);
+            auto n = digits + 24 - q;
+            fast[i] = ok && n && n <= 16 && x >= -EXP_MAX && x <= EXP_MAX;
+            exp10[i] = static_cast<signed char>(fast[i] ? x : 0);
+
+            std::memcpy(&hi[i], digits + 8, 8);
+            std::memcpy(&lo[i], digits + 16, 8);
+        }
+
+        // pass 2: validate and accumulate the digits in bulk
+        for (size_type i = 0; i != m; ++i)
+        {
+            valid[i] = detail::is_digits_swar(hi[i]) & detail::is_digits_swar(lo[i]);
+            sig[i] = detail::digits_swar(hi[i]) * 100000000 + detail::digits_swar(lo[i]);
+        }
+
+        // pass 3: finalize the values
+        for (size_type i = 0; i != m; ++i)
+        {
+            auto& v = values[k + i];
+            if (fast[i] && valid[i] && sig[i] <= SIG_MAX)
+            {
+                if constexpr (std::is_floating_point_v<T>)
+                {
+                    v = static_cast<T>(sig[i]);
+                    v = exp10[i] < 0 ? v / POW10[-exp10[i]] : v * POW10[exp10[i]];
+                    if (neg[i])
+                        v = -v;
+
+                    continue;
+                }
+                else
+                {
+                    // sig[i] < 10^16 fits in std::int64_t
+                    auto s = static_cast<std::int64_t>(sig[i]);
+                    if (neg[i])
+                        s = -s;
+
+                    auto in_range = false;
+                    if constexpr (std::is_signed_v<T>)
+                    {
+                        in_range = s >= static_cast<std::int64_t>(std::numeric_limits<T>::min())
+                                   && s <= static_cast<std::int64_t>(std::numeric_limits<T>::max());
+                    }
+                    else
+                        in_range = sig[i] <= static_cast<std::uint64_t>(std::numeric_limits<T>::max());
+
+                    if (in_range)
+                    {
+                        v = static_cast<T>(s);
+                        continue;
+                    }
+                }
+            }
+
+            if (from_field(fields[k + i], v))
+                continue;
+
+            v = T {};
+            ++failure_num;
+        }
+    }
+
+    return failure_num;
+}
+
+/**
+ * @brief decode a numeric column into values, which is resized to fields.size()
+ *
+ * @return the number of fields that cannot be converted.
+ */
+template<typename T>
+size_type decode_column(std::span<const std::string_view> fields, std::vector<T>& values)
+{
+    values.resize(fields.size());
+    return decode_column(fields, values.data());
+}
+
+/**
+ * @brief the tokens of missing values, e.g., NullTokens {"", "NA", "NaN"}
+ *
+ * @details a field is null if it matches any token with its enclosing double quotes removed.
+ *          the default one takes the empty field only.
+ */
+class NullTokens {
+public:
+    NullTokens() : tokens {std::string{}}
+    {
+    }
+
+    NullTokens(std::initializer_list<std::string_view> tokens_)
+        : tokens(tokens_.begin(), tokens_.end())
+    {
+    }
+
+    bool contains(std::string_view sv) const
+    {
+        sv = unquote(sv);
+        return std::find(tokens.begin(), tokens.end(), sv) != tokens.end();
+    }
+
+    const std::vector<std::string>& get_tokens() const
+    {
+        return tokens;
+    }
+
+private:
+    std::vector<std::string> tokens;
+};
+
+/**
+ * @brief a floating-point number along with the number of significant digits to format it
+ *        with, e.g., Row {id, with_precision(length, 3)} or writer.write_row_raw(id,
+ *        with_precision(length, 3)), which overrides BaseWriter::set_precision()
+ */
+template<typename T>
+struct WithPrecision {
+    static_assert(std::is_floating_point_v<T>, "WithPrecision only takes floating-point numbers");
+
+    T value;
+    int precision;
+};
+
+template<typename T>
+WithPrecision<T> with_precision(T t, int precision)
+{
+    return {t, precision};
+}
+
+namespace detail
+{
+template<typename T>
+struct is_with_precision : std::false_type {};
+
+template<typename T>
+struct is_with_precision<WithPrecision<T>> : std::true_type {};
+
+/**
+ * @brief format t into [b, e) via std::to_chars, where t is an arithmetic type other than bool
+ *        and char or a WithPrecision
+ *
+ * @details floating-point numbers take the shortest representation that round-trips if
+ *          precision is negative, or precision significant digits as printf("%.*g") otherwise.
+ */
+template<typename T>
+std::to_chars_result format_number(char* b, char* e, const T& t, int precision = -1)
+{
+    if constexpr (is_with_precision<T>::value)
+        return format_number(b, e, t.value, t.precision);
+    else if constexpr (std::is_integral_v<T>)
+        return std::to_chars(b, e, t);
+    else if (precision < 0)
+        return std::to_chars(b, e, t);
+    else
+        return std::to_chars(b, e, t, std::chars_format::general, precision);
+}
+
+// the fallback of format_number() via operator<<
+template<typename T>
+std::string format_stream(const T& t, int precision = -1)
+{
+    std::ostringstream os;
+    if constexpr (is_with_precision<T>::value)
+    {
+        return format_stream(t.value, t.precision);
+    }
+    else
+    {
+        if (precision >= 0)
+            os.precision(precision);
+        else if constexpr (std::is_floating_point_v<T>)
+            os.precision(std::numeric_limits<T>::max_digits10);
+
+        os << t;
+        return os.str();
+    }
+}
+
+// char types (incl. std::int8_t and std::uint8_t) are taken as chars as operator<< does
+template<typename T>
+inline constexpr bool is_char_v = std::is_same_v<T, char> || std::is_same_v<T, signed char>
+                                  || std::is_same_v<T, unsigned char>;
+
+template<typename T>
+inline constexpr bool is_number_v = (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>
+                                     && !is_char_v<T>) || is_with_precision<T>::value;
+} // namespace detail
+
+/**
+ * @brief a custom exception which arises when a nonexistent field is retrieved
+ * via Row::[] (i.e., no such a field in the header)
+ */
+struct NoRecord : public std::runtime_error {
+    NoRecord() = delete;
+
+    explicit NoRecord(const std::string& s)
+        : std::runtime_error{"Row::operator[]: " + s + " is nonexistent"}
+    {
+    }
+
+    explicit NoRecord(size_type s)
+        : std::runtime_error{"Row::operator[]: " + std::to_string(s) + " is out of range"}
+    {
+    }
+};
+
+class Row {
+    friend void attach_fieldnames(Row&, const FieldNames*, size_type);
+    friend std::ostream& operator<<(std::ostream&, const Row&);
+
+public:
+    using Records = std::vector<std::string>;
+    using iterator = Records::iterator;
+    using const_iterator = Records::const_iterator;
+
+    Row() = default;
+
+    // pure string input
+    Row(std::initializer_list<std::string> args)
+    {
+        for (auto& s: args)
+            records.emplace_back(s);
+    }
+
+    /**
+     * @brief convert user's data into records, e.g., Row {"link", 1, with_precision(2.5, 3)}
+     *
+     * @details numbers are formatted via std::to_chars, where floating-point ones take the
+     *          shortest representation that round-trips unless wrapped by with_precision().
+     *          strings are copied as they are, and other types go through operator<<.
+     *          numbers are formatted on the stack, so a record only allocates if it is
+     *          beyond the short string optimization (e.g., 15 chars for libstdc++), as
+     *          "0.30000000000000004" is.
+     */
+    template<typename T, typename... Args>
+    Row(const T& t, const Args&... args)
+    {
+        records.reserve(sizeof...(args) + 1);
+        convert_to_string(t);
+        (convert_to_string(args), ...);
+    }
+
+    Row(Records&& r)
+    {
+        records = r;
+    }
+
+    Row(const Row&) = default;
+    Row& operator=(const Row&) = delete;
+
+    Row(Row&&) = default;
+    Row& operator=(Row&&) = default;
+
+    ~Row() = default;
+
+    std::string& operator[](size_type i)
+    {
+        if (i >= records.size())
+            throw NoRecord{i};
+
+        return records[i];
+    }
+
+    const std::string& operator[](size_type i) const
+    {
+        if (i >= records.size())
+            throw NoRecord{i};
+
+        return records[i];
+    }
+
+    std::string& operator[](std::string_view s)
+    {
+        auto i = fns ? fns->find(s) : FieldNames::npos;
+        if (i == FieldNames::npos)
+            throw NoRecord{std::string{s}};
+
+        // more fieldnames than fields will be taken care by operator[]
+        return (*this)[i];
+    }
+
+    /**
+     * @brief retrieve a field (record) using fieldname (header)
+     *
+     * in case of data inconsistency, the following two cases are considered.
+     *
+     * 1. if there are more fields than fieldnames, users can only retrieve those
+     * extra fields (with no corresponding fieldnames) using indices via overloaded
+     * [].
+     * 2. if there are more fieldnames than fields, an exception NoRecord will be
+     * thrown at run time.
+     *
+     * Note that our way handling these two exceptions are different with Python
+     * csv.DictReader, where, extra fields will be concatenated as a list
+     * (of strings) with None assigned as a new fieldname for case 1; None will
+     * be output for case 2.
+     *
+     * @param s
+     * @return const std::string&
+     */
+    const std::string& operator[](std::string_view s) const
+    {
+        auto i = fns ? fns->find(s) : FieldNames::npos;
+        if (i == FieldNames::npos)
+            throw NoRecord{std::string{s}};
+
+        // more fieldnames than fields will be taken care by operator[]
+        return (*this)[i];
+    }
+
+    std::string& operator[](Column c)
+    {
+        return (*this)[c.get_index()];
+    }
+
+    // retrieve a field (record) using a fieldname resolved in advance
+    const std::string& operator[](Column c) const
+    {
+        return (*this)[c.get_index()];
+    }
+
+    /**
+     * @brief retrieve a field (record) without throwing
+     *
+     * @return nullptr if there is no such a fieldname or no corresponding field
+     */
+    const std::string* find(std::string_view s) const noexcept
+    {
+        return get_if(fns ? fns->find(s) : FieldNames::npos);
+    }
+
+    const std::string* get_if(size_type i) const noexcept
+    {
+        return i < records.size() ? &records[i] : nullptr;
+    }
+
+    const std::string* get_if(Column c) const noexcept
+    {
+        return get_if(c.get_index());
+    }
+
+    /**
+     * @brief retrieve a field (record) as a value of type T, e.g., get<double>(i)
+     *
+     * @details the field is converted directly from its chars via from_field().
+     *
+     * @return std::nullopt if the field is nonexistent, empty, or ill-formed for T. an empty
+     *         field is an empty std::string or std::string_view rather than std::nullopt.
+     */
+    template<typename T>
+    std::optional<T> get(size_type i) const
+    {
+        T t;
+        if (i < records.size() && from_field(records[i], t))
+            return t;
+
+        return std::nullopt;
+    }
+
+    template<typename T>
+    std::optional<T> get(std::string_view s) const
+    {
+        return get<T>(fns ? fns->find(s) : FieldNames::npos);
+    }
+
+    template<typename T>
+    std::optional<T> get(Column c) const
+    {
+        return get<T>(c.get_index());
+    }
+
+    std::string& back()
+    {
+        return records.back();
+    }
+
+    const std::string& back() const
+    {
+        return records.back();
+    }
+
+    iterator begin()
+    {
+        return records.begin();
+    }
+
+    const_iterator begin() const
+    {
+        return records.begin();
+    }
+
+    iterator end()
+    {
+        return records.end();
+    }
+
+    const_iterator end() const
+    {
+        return records.end();
+    }
+
+    size_type size() const
+    {
+        return records.size();
+    }
+
+    bool empty() const
+    {
+        return records.size() == 0;
+    }
+
+    // move non-const string
+    void append(std::string& s)
+    {
+        records.emplace_back(s);
+    }
+
+    // move rvalue string
+    void append(std::string&& s)
+    {
+        records.push_back(std::move(s));
+    }
+
+    // copy const string with no move
+    void append(const std::string& s)
+    {
+        records.push_back(s);
+    }
+
+    // construct the string in place
+    void append(const std::string_view sv)
+    {
+        records.emplace_back(sv);
+    }
+
+private:
+    Records records;
+    // reserved for DictReader
+    const FieldNames* fns = nullptr;
+
+    template<typename T>
+    void convert_to_string(const T& t)
+    {
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            // as operator<< does
+            records.emplace_back(1, t ? '1' : '0');
+        }
+        else if constexpr (detail::is_char_v<T>)
+        {
+            records.emplace_back(1, static_cast<char>(t));
+        }
+        else if constexpr (detail::is_number_v<T>)
+        {
+            char chars[128];
+            auto res = detail::format_number(chars, chars + sizeof(chars), t);
+            if (res.ec == std::errc{})
+                records.emplace_back(chars, res.ptr);
+            else
+                records.push_back(detail::format_stream(t));
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+        {
+            records.emplace_back(std::string_view{t});
+        }
+        else
+        {
+            std::ostringstream os;
+            os << t;
+            // os.str() will be moved into records as os.str() is a rvalue reference
+            records.push_back(os.str());
+        }
+    }
+};
+
+/**
+ * @brief a row of fields referring to chars owned by others (e.g., a memory mapped file)
+ *
+ * it is the allocation-free counterpart of Row. it is only valid until the next row is
+ * parsed into it or the chars are released.
+ */
+class RowView {
+public:
+    using Records = std::vector<std::string_view>;
+    using const_iterator = Records::const_iterator;
+
+    RowView() = default;
+
+    std::string_view operator[](size_type i) const
+    {
+        if (i >= records.size())
+            throw NoRecord{i};
+
+        return records[i];
+    }
+
+    const_iterator begin() const
+    {
+        return records.begin();
+    }
+
+    const_iterator end() const
+    {
+        return records.end();
+    }
+
+    size_type size() const
+    {
+        return records.size();
+    }
+
+    bool empty() const
+    {
+        return records.empty();
+    }
+
+    // see Row::get()
+    template<typename T>
+    std::optional<T> get(size_type i) const
+    {
+        T t;
+        if (i < records.size() && from_field(records[i], t))
+            return t;
+
+        return std::nullopt;
+    }
+
+    void append(std::string_view sv)
+    {
+        records.push_back(sv);
+    }
+
+    // keep the capacity for the next row
+    void clear()
+    {
+        records.clear();
+    }
+
+private:
+    Records records;
+};
+
+// not a pure abstract class
+class BaseReader {
+public:
+    BaseReader() : quote {'"'}, row_num {0}
+    {
+    }
+
+    BaseReader(const BaseReader&) = delete;
+    BaseReader& operator=(const BaseReader&) = delete;
+
+    BaseReader(BaseReader&&) = default;
+    BaseReader& operator=(BaseReader&&) = delete;
+
+    virtual ~BaseReader()
+    {
+    }
+
+    // forward declaration
+    class ReaderIterator;
+
+    ReaderIterator begin();
+    ReaderIterator end();
+
+    size_type get_row_num() const
+    {
+        return row_num;
+    }
+
+protected:
+    const char quote;
+    size_type row_num;
+
+    Row row;
+
+    const char CR = '\r';
+    const char LF = '\n';
+
+    /**
+     * @deprecated
+     *
+     * @note promote direct warning message (since 12/01/24) (rather than throwing, catching, and
+     *       printing out the exception message) simplies the implementation and improves the
+     *       performance.
+     *
+     *       see Reader::split(), Reader::split2(), Reader::split3(), and BaseMIOReader::parse() for
+     *       details.
+     */
+    struct InvalidRow : public std::runtime_error {
+        // do we need it?
+        InvalidRow() = delete;
+
+        InvalidRow(size_type row_num, const std::string& str)
+            : std::runtime_error{"CAUTION: Invalid Row at line "
+                                 + std::to_string(++row_num)
+                                 + "! Value is not allowed after quoted field: "
+                                 + str}
+        {
+        }
+    };
+
+    /**
+     * @brief move on to the next row
+     *
+     * @return false if EOF is reached, true otherwise.
+     *
+     * @note EOF used to be signaled by throwing IterationEnd, which is expensive when
+     *       parsing a large number of small files (one exception per file).
+     */
+    virtual bool iterate() = 0;
+};
+
+class BaseReader::ReaderIterator {
+public:
+    ReaderIterator() = delete;
+
+    ReaderIterator(BaseReader* r_) : r {r_}
+    {
+        if (r && !r->iterate())
+            r = nullptr;
+    }
+
+    ReaderIterator(const ReaderIterator&) = default;
+    ReaderIterator& operator=(const ReaderIterator&) = delete;
+
+    ReaderIterator(ReaderIterator&&) = default;
+    ReaderIterator& operator=(ReaderIterator&&) = delete;
+
+    ~ReaderIterator() = default;
+
+    ReaderIterator operator++()
+    {
+        if (!r->iterate())
+            r = nullptr;
+
+        return *this;
+    }
+
+    bool operator==(const ReaderIterator& it) const
+    {
+        return r == it.r;
+    }
+
+    bool operator!=(const ReaderIterator& it) const
+    {
+        return r != it.r;
+    }
+
+    const Row& operator*() const
+    {
+        return r->row;
+    }
+
+private:
+    BaseReader* r;
+};
+
+// dreaded diamond
+class BaseDictReader : public virtual BaseReader {
+public:
+    BaseDictReader() = default;
+
+    void setup_headers(const Row& r)
+    {
+        for (size_type i = 0, sz = r.size(); i != sz; ++i)
+        {
+            const auto& s = r[i];
+            fns[s] = i;
+        }
+
+        if (fns.empty() && row_num == 0 && iterate())
+            setup_headers(row);
+    }
+
+    const FieldNames& get_fieldnames() const
+    {
+        return fns;
+    }
+
+    /**
+     * @brief resolve a fieldname to a Column for O(1) retrieval from rows
+     *
+     * @note NoRecord will be thrown if there is no such a fieldname.
+     */
+    Column column(std::string_view s) const
+    {
+        auto i = fns.find(s);
+        if (i == FieldNames::npos)
+            throw NoRecord{std::string{s}};
+
+        return Column{i};
+    }
+
+protected:
+    FieldNames fns;
+};
+
+// dreaded diamond
+class Reader : public virtual BaseReader {
+public:
+    Reader() = delete;
+
+    Reader(const std::string& ist_, const char delim_ = ',')
+        : BaseReader{}, ist {ist_}, delim {delim_}
+    {
+        if (!ist)
+        {
+            std::cerr << "invalid input! no " << ist_ << '\n';
+            std::terminate();
+        }
+#ifdef O3N_TIME_BOUND
+        it = ist;
+#endif
+    }
+
+    Reader(std::string&& ist_, const char delim_ = ',')
+        : BaseReader{}, ist {ist_}, delim {delim_}
+    {
+        if (!ist)
+        {
+            std::cerr << "invalid input! no " << ist_ << '\n';
+            std::terminate();
+        }
+#ifdef O3N_TIME_BOUND
+        it = ist;
+#endif
+    }
+
+protected:
+    std::ifstream ist;
+    const char delim;
+
+    bool iterate() override
+    {
+#ifdef O3N_TIME_BOUND
+        if (it == it_end)
+            return false;
+
+        row = split3();
+#else
+        std::string s;
+        if (!std::getline(ist, s))
+            return false;
+
+        row = split2(s);
+#endif
+        ++row_num;
+        return true;
+    }
+
+private:
+#ifdef O3N_TIME_BOUND
+    std::istreambuf_iterator<char> it;
+    std::istreambuf_iterator<char> it_end;
+#endif
+
+    // for benchmark only
+    Row split(const std::string& s) const;
+
+    /**
+     * @brief parse string
+     *
+     * @param C string container, which could be std::string or std::string_view
+     * @return Row
+     *
+     * @note with split2(), the overall time complexity is O(5N) which includes two
+     * linear searches and three copy processes.
+     */
+    template<typename C>
+    Row split2(const C& c) const;
+
+    /**
+     * @brief parse string
+     *
+     * @return Row
+     *
+     * @note with split3(), the overall time complexity is O(3N) which includes one
+     * linear search and two copy processes.
+     */
+    Row split3();
+};
+
+class DictReader : public Reader, public BaseDictReader {
+public:
+    DictReader() = delete;
+
+    DictReader(const std::string& ist_, const Row& fieldnames_ = {}, const char delim_ = ',')
+        : Reader{ist_}, BaseDictReader{}
+    {
+        setup_headers(fieldnames_);
+    }
+
+    DictReader(std::string&& ist_, const Row& fieldnames_ = {}, const char delim_ = ',')
+        : Reader{ist_}, BaseDictReader{}
+    {
+        setup_headers(fieldnames_);
+    }
+
+private:
+    bool iterate() override
+    {
+        // do not take blank lines in consistent with Python csv.DictReader
+        do
+        {
+            if (!Reader::iterate())
+                return false;
+        } while (row.empty());
+
+        if (row_num > 1)
+            attach_fieldnames(row, &fns, row_num);
+
+        return true;
+    }
+};
+
+/**
+ * @brief the common part of writers, which formats rows into an output buffer of its own and
+ *        hands it over to the sink of a derived writer in large chunks
+ *
+ * @details integers and floating-point numbers are formatted via std::to_chars rather than
+ *          std::ostream::operator<<, which goes through the locale and the sentry per call.
+ *          any other type is taken as a string if convertible to std::string_view, or goes
+ *          through operator<< as before.
+ */
+class BaseWriter {
+public:
+    // the size of the buffered output to hand over at a time
+    static constexpr size_type BUFFER_SIZE = 1 << 20;
+
+    BaseWriter() = delete;
+
+    explicit BaseWriter(const char delim_) : delim {delim_}
+    {
+        buf.reserve(BUFFER_SIZE);
+    }
+
+    BaseWriter(const BaseWriter&) = delete;
+    BaseWriter& operator=(const BaseWriter&) = delete;
+
+    BaseWriter(BaseWriter&& other)
+        : buf {std::move(other.buf)}, delim {other.delim}, precision {other.precision}
+    {
+        // nothing left for the destructor of other to flush
+        other.buf.clear();
+    }
 
-    ReaderIterator begin();
-    ReaderIterator end();
+    BaseWriter& operator=(BaseWriter&&) = delete;
 
-    size_type get_row_num() const
+    // derived writers shall flush() in their destructors as their sinks are gone here
+    virtual ~BaseWriter() = default;
+
+    /**
+     * @brief set the precision of floating-point numbers, i.e., the number of significant
+     *        digits as printf("%.*g"). a negative one (the default) gives the shortest
+     *        representation that round-trips.
+     */
+    void set_precision(int precision_)
     {
-        return row_num;
+        precision = precision_;
     }
 
-protected:
-    const char quote;
-    size_type row_num;
+    int get_precision() const
+    {
+        return precision;
+    }
 
-    Row row;
+    // hand over all the buffered output to the sink
+    virtual void flush()
+    {
+        if (!buf.empty())
+            hand_over();
+    }
 
-    const char CR = '\r';
-    const char LF = '\n';
+    /**
+     * @brief append context into the file
+     *
+     * @note need to make sure that the context has NO delimiter
+     *
+     * @param t a const reference of typename T
+     * @param sep separator, which could be any valid char. its default is ',' as
+     * for csv files.
+     */
+    template<typename T>
+    void append(const T& t, const char sep = ',')
+    {
+        put(t);
+        buf.push_back(sep);
+        try_flush();
+    }
 
     /**
-     * @deprecated
+     * @brief append context into the file
      *
-     * @note promote direct warning message (since 12/01/24) (rather than throwing, catching, and
-     *       printing out the exception message) simplies the implementation and improves the
-     *       performance.
+     * @note need to make sure that the context has NO delimiter
      *
-     *       see Reader::split(), Reader::split2(), Reader::split3(), and MIOReader::parse() for
-     *       details.
+     * @param t a const reference of typename T
+     * @param str any valid string.
      */
-    struct InvalidRow : public std::runtime_error {
-        // do we need it?
-        InvalidRow() = delete;
+    template<typename T>
+    void append(const T& t, const std::string& str)
+    {
+        put(t);
+        buf.append(str);
+        try_flush();
+    }
 
-        InvalidRow(size_type row_num, const std::string& str)
-            : std::runtime_error{"CAUTION: Invalid Row at line "
-                                 + std::to_string(++row_num)
-                                 + "! Value is not allowed after quoted field: "
-                                 + str}
+    /**
+     * @brief write a row of records into the file
+     *
+     * @details a record is quoted if it contains the delimiter, '"', CR, or LF, where any
+     * embedded '"' is doubled as RFC 4180 specifies. others are written as they are.
+     *
+     * @note if no records need quoting, then a simple implementation via the
+     * overloaded operator<< for Row would work fine, i.e., os << r << '\n'. It
+     * has been implemented as write_row_raw()
+     *
+     * @param r a const reference of miocsv::Row
+     */
+    void write_row(const Row& r)
+    {
+        for (size_type i = 0, sz = r.size(); i != sz; ++i)
         {
+            if (i)
+                buf.push_back(delim);
+
+            put_escaped(r[i]);
         }
-    };
 
-    class IterationEnd {
+        buf.push_back('\n');
+        try_flush();
+    }
 
-    };
+    /**
+     * @brief write a row of records having no delimiters into the file
+     *
+     * @note users need to make sure that each record has NO delimiter. it does
+     * not have handling on delimiter inside a cell as write_row(). It simply
+     * writes as is.
+     *
+     * @param t a const reference of typename T
+     * @param args const reference of variadic template T
+     */
+    template<typename T, typename... Args>
+    void write_row_raw(const T& t, const Args&... args)
+    {
+        put(t);
+        ((buf.push_back(delim), put(args)), ...);
+        buf.push_back('\n');
+        try_flush();
+    }
 
-    virtual void iterate() = 0;
-};
+    /**
+     * @brief write columns (i.e., structure of arrays) row by row with an optional header, e.g.,
+     *
+     *  writer.write_columns({"link_id", "length", "name"}, ids, lengths, names);
+     *
+     * @details a column could be any container with size() and operator[], e.g., std::vector,
+     * std::span, StringColumn, or EncodedColumn. the formatting of each column is chosen at
+     * compile time by its value type, where strings are quoted and escaped as write_row() does.
+     *
+     * @note if columns have different sizes, the rows up to the shortest are written.
+     */
+    template<typename... Cols>
+    void write_columns(const Row& header, const Cols&... cols)
+    {
+        static_assert(sizeof...(cols) > 0, "write_columns takes at least one column");
 
-class BaseReader::ReaderIterator {
-public:
-    ReaderIterator() = delete;
+        if (!header.empty())
+            write_row(header);
 
-    ReaderIterator(BaseReader* r_) : r {r_}
-    {
-        if (!r)
-            return;
+        auto n = std::min({static_cast<size_type>(cols.size())...});
+        if (((cols.size() != n) || ...))
+            std::cerr << "CAUTION: columns of different sizes, only the first " << n << " rows are written\n";
 
-        try
+        for (size_type i = 0; i != n; ++i)
         {
-            r->iterate();
+            write_fields(cols[i]...);
+            try_flush();
         }
-        catch (IterationEnd)
+    }
+
+    /**
+     * @brief write a range of rows, each of which is a Row or a tuple-like one (e.g.,
+     *        std::tuple, std::pair, or std::array) formatted as write_columns() does
+     */
+    template<typename Range>
+    void write_rows(const Range& rows)
+    {
+        for (const auto& r : rows)
         {
-            r = nullptr;
+            using R = std::decay_t<decltype(r)>;
+            if constexpr (std::is_same_v<R, Row>)
+            {
+                write_row(r);
+            }
+            else
+            {
+                static_assert(detail::is_tuple_like<R>::value, "write_rows takes Row or tuple-like rows");
+
+                std::apply([this](const auto&... fields) { write_fields(fields...); }, r);
+                try_flush();
+            }
         }
     }
 
-    ReaderIterator(const ReaderIterator&) = default;
-    ReaderIterator& operator=(const ReaderIterator&) = delete;
+protected:
+    std::string buf;
+    const char delim;
+    int precision = -1;
 
-    ReaderIterator(ReaderIterator&&) = default;
-    ReaderIterator& operator=(ReaderIterator&&) = delete;
+    /**
+     * @brief hand over n chars from p to the sink
+     */
+    virtual void write_out(const char* p, size_type n) = 0;
 
-    ~ReaderIterator() = default;
+    /**
+     * @brief hand over the nonempty buf to the sink and leave it empty
+     */
+    virtual void hand_over()
+    {
+        write_out(buf.data(), buf.size());
+        buf.clear();
+    }
 
-    ReaderIterator operator++()
+    void try_flush()
     {
-        try
+        if (buf.size() >= BUFFER_SIZE)
+            hand_over();
+    }
+
+    // append a row of fields, where strings are quoted and escaped if needed
+    template<typename T, typename... Args>
+    void write_fields(const T& t, const Args&... args)
+    {
+        put_field(t);
+        ((buf.push_back(delim), put_field(args)), ...);
+        buf.push_back('\n');
+    }
+
+    template<typename T>
+    void put_field(const T& t)
+    {
+        if constexpr (detail::is_char_v<T>)
         {
-            r->iterate();
+            // a single char, e.g., ',' or '"', could also break the row
+            auto c = static_cast<char>(t);
+            put_escaped({&c, 1});
         }
-        catch (IterationEnd)
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+            put_escaped(t);
+        else
+            put(t);
+    }
+
+    // append s to buf, quoted and escaped if needed
+    void put_escaped(std::string_view s)
+    {
+        if (!detail::needs_quoting(s, delim))
         {
-            r = nullptr;
+            buf.append(s);
+            return;
         }
 
-        return *this;
+        buf.push_back('"');
+        for (auto i = s.find('"'); i != std::string_view::npos; i = s.find('"'))
+        {
+            buf.append(s.data(), i + 1);
+            buf.push_back('"');
+            s.remove_prefix(i + 1);
+        }
+
+        buf.append(s);
+        buf.push_back('"');
     }
 
-    bool operator==(const ReaderIterator& it) const
+    // format t at the end of buf
+    template<typename T>
+    void put(const T& t)
     {
-        return r == it.r;
+        if constexpr (std::is_same_v<T, bool>)
+        {
+            // as operator<< does
+            buf.push_back(t ? '1' : '0');
+        }
+        else if constexpr (detail::is_char_v<T>)
+        {
+            buf.push_back(static_cast<char>(t));
+        }
+        else if constexpr (detail::is_number_v<T>)
+        {
+            char chars[128];
+            auto res = detail::format_number(chars, chars + sizeof(chars), t, precision);
+            if (res.ec == std::errc{})
+                buf.append(chars, res.ptr);
+            else
+                buf.append(detail::format_stream(t, precision));
+        }
+        else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+        {
+            buf.append(std::string_view{t});
+        }
+        else if constexpr (std::is_same_v<T, Row>)
+        {
+            // as operator<< does
+            for (size_type i = 0, sz = t.size(); i != sz; ++i)
+            {
+                if (i)
+                    buf.push_back(',');
+
+                buf.append(t[i]);
+            }
+        }
+        else
+        {
+            std::ostringstream os;
+            os << t;
+            buf.append(os.str());
+        }
     }
+};
 
-    bool operator!=(const ReaderIterator& it) const
+/**
+ * @brief a writer that writes to a file on the calling thread
+ *
+ * @note std::runtime_error will be thrown by the call handing over a buffer (or flush())
+ *       if the output cannot be written, e.g., the disk is full.
+ */
+class Writer : public BaseWriter {
+public:
+    Writer() = delete;
+
+    Writer(const std::string& ost_, const char delim_ = ',') : BaseWriter{delim_}, path {ost_}
     {
-        return r != it.r;
+        setup();
     }
 
-    const Row& operator*() const
+    Writer(std::string&& ost_, const char delim_ = ',') : BaseWriter{delim_}, path {std::move(ost_)}
     {
-        return r->row;
+        setup();
+    }
+
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer) = delete;
+
+    Writer(Writer&&) = default;
+    Writer& operator=(Writer&&) = delete;
+
+    ~Writer()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+        }
     }
 
 private:
-    BaseReader* r;
+    std::string path;
+    std::ofstream ost;
+
+    void setup()
+    {
+        // no buffering by ost as the output is already in large chunks
+        ost.rdbuf()->pubsetbuf(nullptr, 0);
+        ost.open(path);
+        if (!ost)
+        {
+            std::cerr << "invalid input! no " << path << '\n';
+            std::terminate();
+        }
+    }
+
+    void write_out(const char* p, size_type n) override
+    {
+        if (!ost.write(p, static_cast<std::streamsize>(n)))
+            throw std::runtime_error{"Writer: failed to write to " + path};
+    }
 };
 
-// dreaded diamond
-class BaseDictReader : public virtual BaseReader {
+/**
+ * @brief a writer that formats rows on the calling thread and writes them out on a
+ *        dedicated I/O thread, e.g., to keep a simulation loop from stalling on the disk
+ *
+ * @details it is double buffered. a full buffer is swapped (i.e., no copy) with the one
+ *          owned by the I/O thread, which writes it out and leaves it empty for the next
+ *          swap. the memory is thus bounded by two buffers, and the calling thread only
+ *          waits if the I/O thread is still busy with the previous buffer.
+ *
+ * @note a failure on writing is rethrown as std::runtime_error by the next call handing
+ *       over a buffer, flush(), or close(), and the output from then on is dropped.
+ */
+class AsyncWriter : public BaseWriter {
 public:
-    BaseDictReader() = default;
+    AsyncWriter() = delete;
 
-    void setup_headers(const Row& r)
+    AsyncWriter(const std::string& ost_, const char delim_ = ',') : BaseWriter{delim_}, path {ost_}
     {
-        for (size_type i = 0, sz = r.size(); i != sz; ++i)
+        setup();
+    }
+
+    AsyncWriter(std::string&& ost_, const char delim_ = ',') : BaseWriter{delim_}, path {std::move(ost_)}
+    {
+        setup();
+    }
+
+    // the I/O thread refers to this
+    AsyncWriter(const AsyncWriter&) = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    AsyncWriter(AsyncWriter&&) = delete;
+    AsyncWriter& operator=(AsyncWriter&&) = delete;
+
+    ~AsyncWriter()
+    {
+        try
         {
-            const auto& s = r[i];
-            fns[s] = i;
+            close();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
         }
+    }
+
+    /**
+     * @brief hand over the buffered output and wait until it is all written out
+     */
+    void flush() override
+    {
+        BaseWriter::flush();
+
+        std::unique_lock<std::mutex> lk {mtx};
+        cv.wait(lk, [this] { return !pending; });
+        check_failure();
+    }
+
+    /**
+     * @brief write out the buffered output, stop the I/O thread, and close the file
+     *
+     * @note nothing can be written after it.
+     */
+    void close()
+    {
+        if (!io.joinable())
+            return;
 
-        if (fns.empty() && row_num == 0)
         {
-            try
-            {
-                iterate();
-                setup_headers(row);
-            }
-            catch (IterationEnd)
+            std::unique_lock<std::mutex> lk {mtx};
+            cv.wait(lk, [this] { return !pending; });
+            if (!buf.empty() && !failed)
             {
-                return;
+                buf.swap(back);
+                pending = true;
             }
+
+            stopped = true;
         }
-    }
 
-    const FieldNames& get_fieldnames() const
-    {
-        return fns;
+        cv.notify_all();
+        io.join();
+        ost.close();
+        buf.clear();
+        check_failure();
     }
 
-protected:
-    FieldNames fns;
-};
+private:
+    std::string path;
+    std::ofstream ost;
 
-// dreaded diamond
-class Reader : public virtual BaseReader {
-public:
-    Reader() = delete;
+    // the buffer owned by the I/O thread
+    std::string back;
+    bool pending = false;
+    bool stopped = false;
+    bool failed = false;
 
-    Reader(const std::string& ist_, const char delim_ = ',')
-        : BaseReader{}, ist {ist_}, delim {delim_}
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread io;
+
+    void setup()
     {
-        if (!ist)
+        ost.rdbuf()->pubsetbuf(nullptr, 0);
+        ost.open(path);
+        if (!ost)
         {
-            std::cerr << "invalid input! no " << ist_ << '\n';
+            std::cerr << "invalid input! no " << path << '\n';
             std::terminate();
         }
-#ifdef O3N_TIME_BOUND
-        it = ist;
-#endif
+
+        back.reserve(BUFFER_SIZE);
+        io = std::thread {&AsyncWriter::run, this};
     }
 
-    Reader(std::string&& ist_, const char delim_ = ',')
-        : BaseReader{}, ist {ist_}, delim {delim_}
+    void check_failure() const
+    {
+        if (failed)
+            throw std::runtime_error{"AsyncWriter: failed to write to " + path};
+    }
+
+    void hand_over() override
     {
-        if (!ist)
         {
-            std::cerr << "invalid input! no " << ist_ << '\n';
-            std::terminate();
+            std::unique_lock<std::mutex> lk {mtx};
+            cv.wait(lk, [this] { return !pending; });
+            if (failed || stopped)
+            {
+                buf.clear();
+                check_failure();
+                return;
+            }
+
+            buf.swap(back);
+            pending = true;
         }
-#ifdef O3N_TIME_BOUND
-        it = ist;
-#endif
+
+        cv.notify_all();
     }
 
-protected:
-    std::ifstream ist;
-    const char delim;
+    void write_out(const char* p, size_type n) override
+    {
+        ost.write(p, static_cast<std::streamsize>(n));
+    }
 
-    void iterate() override
+    // the loop of the I/O thread
+    void run()
     {
-#ifdef O3N_TIME_BOUND
-        if (it == it_end)
-            throw IterationEnd{};
+        std::unique_lock<std::mutex> lk {mtx};
+        while (true)
+        {
+            cv.wait(lk, [this] { return pending || stopped; });
+            if (!pending)
+                return;
 
-        row = split3();
-#else
-        std::string s;
-        if (!std::getline(ist, s))
-            throw IterationEnd{};
+            // back is not touched by the calling thread while pending
+            lk.unlock();
+            write_out(back.data(), back.size());
+            bool ok = static_cast<bool>(ost);
+            back.clear();
+            lk.lock();
 
-        row = split2(s);
-#endif
-        ++row_num;
+            failed = failed || !ok;
+            pending = false;
+            cv.notify_all();
+        }
     }
+};
 
-private:
-#ifdef O3N_TIME_BOUND
-    std::istreambuf_iterator<char> it;
-    std::istreambuf_iterator<char> it_end;
-#endif
+namespace detail
+{
+// a buffer handed over by a producer of ConcurrentWriter to its flushing thread
+struct WriterNode {
+    std::string buf;
+    WriterNode* next = nullptr;
+    // true until buf is written out and can be reused by the producer
+    std::atomic<bool> in_flight {false};
+};
 
-    // for benchmark only
-    Row split(const std::string& s) const;
+/**
+ * @brief a lock-free multi-producer single-consumer queue of WriterNode
+ *
+ * @details producers push nodes onto an intrusive stack via compare-and-swap. the consumer
+ *          takes the whole stack at once via exchange and reverses it, which restores the
+ *          order of pushing and is free of the ABA problem.
+ */
+class WriterQueue {
+public:
+    void push(WriterNode* node)
+    {
+        node->next = head.load(std::memory_order_relaxed);
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release,
+                                           std::memory_order_relaxed))
+            ;
 
-    /**
-     * @brief parse string
-     *
-     * @param C string container, which could be std::string or std::string_view
-     * @return Row
-     *
-     * @note with split2(), the overall time complexity is O(5N) which includes two
-     * linear searches and three copy processes.
-     */
-    template<typename C>
-    Row split2(const C& c) const;
+        head.notify_one();
+    }
 
-    /**
-     * @brief parse string
-     *
-     * @return Row
-     *
-     * @note with split3(), the overall time complexity is O(3N) which includes one
-     * linear search and two copy processes.
-     */
-    Row split3();
+    // take all the nodes in the order of pushing, which waits if there are none
+    WriterNode* pop_all()
+    {
+        head.wait(nullptr, std::memory_order_acquire);
+
+        WriterNode* node = head.exchange(nullptr, std::memory_order_acquire);
+        WriterNode* prev = nullptr;
+        while (node)
+        {
+            auto* next = node->next;
+            node->next = prev;
+            prev = node;
+            node = next;
+        }
+
+        return prev;
+    }
+
+private:
+    std::atomic<WriterNode*> head {nullptr};
 };
 
-class DictReader : public Reader, public BaseDictReader {
+/**
+ * @brief the writer of a producer thread of ConcurrentWriter, which is double buffered with
+ *        its node, i.e., a full buffer is swapped into the node and queued unless the node
+ *        is still in flight.
+ */
+class LocalWriter : public BaseWriter {
 public:
-    DictReader() = delete;
+    LocalWriter(const char delim_, int precision_, WriterQueue& queue_,
+                const std::atomic<bool>& failed_, const std::string& path_)
+        : BaseWriter{delim_}, tid {std::this_thread::get_id()}, queue {queue_}, failed {failed_},
+          path {path_}
+    {
+        precision = precision_;
+        node.buf.reserve(BUFFER_SIZE);
+    }
 
-    DictReader(const std::string& ist_, const Row& fieldnames_ = {}, const char delim_ = ',')
-        : Reader{ist_}, BaseDictReader{}
+    std::thread::id get_thread_id() const
     {
-        setup_headers(fieldnames_);
+        return tid;
     }
 
-    DictReader(std::string&& ist_, const Row& fieldnames_ = {}, const char delim_ = ',')
-        : Reader{ist_}, BaseDictReader{}
+    // wait until the last buffer handed over is written out
+    void wait()
     {
-        setup_headers(fieldnames_);
+        node.in_flight.wait(true);
     }
 
 private:
-    void iterate() override
+    std::thread::id tid;
+    WriterNode node;
+    WriterQueue& queue;
+    const std::atomic<bool>& failed;
+    const std::string& path;
+
+    void write_out(const char*, size_type) override
     {
-        Reader::iterate();
-        // do not take blank lines in consistent with Python csv.DictReader
-        while (row.empty())
-            Reader::iterate();
+    }
 
-        if (row_num > 1)
-            attach_fieldnames(row, &fns, row_num);
+    void hand_over() override
+    {
+        wait();
+        if (failed)
+        {
+            buf.clear();
+            throw std::runtime_error{"ConcurrentWriter: failed to write to " + path};
+        }
+
+        node.buf.swap(buf);
+        node.in_flight = true;
+        queue.push(&node);
     }
 };
+} // namespace detail
 
-class Writer {
+/**
+ * @brief a writer shared by multiple producer threads, e.g., simulation workers logging rows
+ *        into the same file, without serializing them
+ *
+ * @details each producer thread formats rows into a writer of its own (i.e., no locking), and
+ *          only hands over full buffers to a single flushing thread through a lock-free queue.
+ *          as buffers only hold whole rows, rows from different threads are never interleaved,
+ *          while their order across threads is not specified.
+ *
+ * @note close(), which is also called by the destructor, shall be called after all the
+ *       producers are done. a failure on writing is rethrown as std::runtime_error as
+ *       AsyncWriter does.
+ */
+class ConcurrentWriter {
 public:
-    Writer() = delete;
+    ConcurrentWriter() = delete;
 
-    Writer(const std::string& ost_, const char delim_ = ',')
-        : ost {ost_}, delim {delim_}
+    ConcurrentWriter(const std::string& ost_, const char delim_ = ',') : path {ost_}, delim {delim_}
     {
-        if (!ost)
-        {
-            std::cerr << "invalid input! no " << ost_ << '\n';
-            std::terminate();
-        }
+        setup();
     }
 
-    Writer(std::string&& ost_, const char delim_ = ',')
-        : ost {ost_}, delim {delim_}
+    ConcurrentWriter(std::string&& ost_, const char delim_ = ',') : path {std::move(ost_)}, delim {delim_}
     {
-        if (!ost)
-        {
-            std::cerr << "invalid input! no " << ost_ << '\n';
-            std::terminate();
-        }
+        setup();
     }
 
-    Writer(const Writer&) = delete;
-    Writer& operator=(const Writer) = delete;
+    ConcurrentWriter(const ConcurrentWriter&) = delete;
+    ConcurrentWriter& operator=(const ConcurrentWriter&) = delete;
 
-    Writer(Writer&&) = default;
-    Writer& operator=(Writer&&) = delete;
+    ConcurrentWriter(ConcurrentWriter&&) = delete;
+    ConcurrentWriter& operator=(ConcurrentWriter&&) = delete;
 
-    ~Writer() = default;
+    ~ConcurrentWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << '\n';
+        }
+    }
 
     /**
-     * @brief append context into the file
+     * @brief set the precision of floating-point numbers as BaseWriter::set_precision()
      *
-     * @note need to make sure that the context has NO delimiter
-     *
-     * @param t a const reference of typename T
-     * @param sep separator, which could be any valid char. its default is ',' as
-     * for csv files.
+     * @note it only applies to the producer threads writing their first rows after it.
      */
-    template<typename T>
-    void append(const T& t, const char sep = ',')
+    void set_precision(int precision_)
     {
-        ost << t << sep;
+        precision = precision_;
     }
 
-    template<typename T>
-    void append(T&& t, const char sep = ',')
+    /**
+     * @brief write a row of records from the calling thread as Writer::write_row()
+     */
+    void write_row(const Row& r)
     {
-        ost << t << sep;
+        get_local().write_row(r);
     }
 
     /**
-     * @brief append context into the file
-     *
-     * @note need to make sure that the context has NO delimiter
-     *
-     * @param t a const reference of typename T
-     * @param str any valid string.
+     * @brief write a row of records having no delimiters from the calling thread as
+     *        Writer::write_row_raw()
      */
-    template<typename T>
-    void append(const T& t, const std::string& str)
+    template<typename T, typename... Args>
+    void write_row_raw(const T& t, const Args&... args)
     {
-        ost << t << str;
+        get_local().write_row_raw(t, args...);
     }
 
-    template<typename T>
-    void append(T&& t, const std::string& str)
+    /**
+     * @brief write columns from the calling thread as BaseWriter::write_columns()
+     */
+    template<typename... Cols>
+    void write_columns(const Row& header, const Cols&... cols)
     {
-        ost << t << str;
+        get_local().write_columns(header, cols...);
     }
 
     /**
-     * @brief write a row of records into the file
-     *
-     * @note if no records contain the delimiter, then a simple implementation via the
-     * overloaded operator<< for Row would work fine, i.e., os << r << '\n'. It
-     * has been implemented as write_row_raw()
-     *
-     * @param r a const reference of miocsv::Row
+     * @brief write a range of rows from the calling thread as BaseWriter::write_rows()
      */
-    void write_row(const Row& r)
+    template<typename Range>
+    void write_rows(const Range& rows)
     {
-        for (auto it = r.begin(), it_end = r.end() - 1; it != it_end; ++it)
-        {
-            // check if the current record contains the delimiter or not
-            if (std::find(it->begin(), it->end(), delim) != it->end())
-                ost << '"' << *it << '"' << delim;
-            else
-                ost << *it << delim;
-        }
-
-        // the last record
-        if (std::find(r.back().begin(), r.back().end(), delim) != r.back().end())
-            ost << '"' << r.back() << '"';
-        else
-            ost << r.back();
+        get_local().write_rows(rows);
+    }
 
-        ost << '\n';
+    /**
+     * @brief hand over the rows from the calling thread and wait until they are written out
+     */
+    void flush()
+    {
+        auto& w = get_local();
+        w.flush();
+        w.wait();
+        check_failure();
     }
 
     /**
-     * @brief write a row of records into the file
-     *
-     * @note if no records contain the delimiter, then a simple implementation via the
-     * overloaded operator<< for Row would work fine, i.e., os << r << '\n'. It
-     * has been implemented as write_row_raw()
-     *
-     * @param r a rvalue reference of miocsv::Row
+     * @brief write out the rows from all the threads, stop the flushing thread, and close
+     *        the file
      */
-    void write_row(Row&& r)
+    void close()
     {
-        for (auto it = r.begin(), it_end = r.end() - 1; it != it_end; ++it)
+        if (!io.joinable())
+            return;
+
+        for (auto& w : locals)
         {
-            // check if the current record contains the delimiter or not
-            if (std::find(it->begin(), it->end(), delim) != it->end())
-                ost << '"' << *it << '"' << delim;
-            else
-                ost << *it << delim;
+            try
+            {
+                w->flush();
+            }
+            catch (const std::runtime_error&)
+            {
+                // reported below
+            }
         }
 
-        // the last record
-        if (std::find(r.back().begin(), r.back().end(), delim) != r.back().end())
-            ost << '"' << r.back() << '"';
-        else
-            ost << r.back();
-
-        ost << '\n';
+        queue.push(&stop);
+        io.join();
+        ost.close();
+        check_failure();
     }
 
-    /**
-     * @brief write a row of records having no delimiters into the file
-     *
-     * @note users need to make sure that each record has NO delimiter. it does
-     * not have handling on delimiter inside a cell as write_row(). It simply
-     * writes as is.
-     *
-     * @param t a const reference of typename T
-     */
-    template<typename T>
-    void write_row_raw(const T& t)
+private:
+    std::string path;
+    const char delim;
+    std::atomic<int> precision {-1};
+
+    std::ofstream ost;
+    detail::WriterQueue queue;
+    // the node telling the flushing thread to stop
+    detail::WriterNode stop;
+    std::atomic<bool> failed {false};
+    std::thread io;
+
+    std::mutex mtx;
+    std::vector<std::unique_ptr<detail::LocalWriter>> locals;
+    // tell apart writers even if one takes the address of another one destroyed
+    const std::uint64_t id = ++writer_num;
+
+    static inline std::atomic<std::uint64_t> writer_num {0};
+
+    void setup()
     {
-        ost << t << '\n';
+        ost.rdbuf()->pubsetbuf(nullptr, 0);
+        ost.open(path);
+        if (!ost)
+        {
+            std::cerr << "invalid input! no " << path << '\n';
+            std::terminate();
+        }
+
+        io = std::thread {&ConcurrentWriter::run, this};
     }
 
-    /**
-     * @brief write a row of records having no delimiters into the file
-     *
-     * @note users need to make sure that each record has NO delimiter. it does
-     * not have handling on delimiter inside a cell as write_row(). It simply
-     * writes as is.
-     *
-     * @param t a const reference of typename T
-     * @param args const reference of variadic template T
-     */
-    template<typename T, typename... Args>
-    void write_row_raw(const T& t, const Args&... args)
+    void check_failure() const
     {
-        ost << t;
-        append_cell(args...);
-        ost << '\n';
+        if (failed)
+            throw std::runtime_error{"ConcurrentWriter: failed to write to " + path};
     }
 
-private:
-    /**
-     * @brief helper function to facilitate write_row_raw()
-     *
-     * @param t a const reference of typename T
-     */
-    template<typename T>
-    void append_cell(const T& t)
+    // the writer of the calling thread, which is cached by the thread
+    detail::LocalWriter& get_local()
     {
-        ost << delim << t;
+        thread_local std::uint64_t cached_id = 0;
+        thread_local detail::LocalWriter* cached = nullptr;
+        if (cached_id == id)
+            return *cached;
+
+        std::lock_guard<std::mutex> lk {mtx};
+        auto tid = std::this_thread::get_id();
+        auto it = std::find_if(locals.begin(), locals.end(),
+                               [tid](const auto& w) { return w->get_thread_id() == tid; });
+        if (it == locals.end())
+        {
+            locals.push_back(std::make_unique<detail::LocalWriter>(delim, precision, queue, failed, path));
+            it = std::prev(locals.end());
+        }
+
+        cached_id = id;
+        cached = it->get();
+        return *cached;
     }
 
-    /**
-     * @brief helper function to facilitate write_row_raw()
-     *
-     * @param t a const reference of typename T
-     * @param args const reference of variadic template T
-     */
-    template<typename T, typename... Args>
-    void append_cell(const T& t, const Args&... args)
+    // the loop of the flushing thread
+    void run()
     {
-        append_cell(t);
-        append_cell(args...);
-    }
+        for (bool stopped = false; !stopped;)
+        {
+            for (auto* node = queue.pop_all(); node;)
+            {
+                // node is taken back by its producer once it is not in flight
+                auto* next = node->next;
+                if (node == &stop)
+                {
+                    stopped = true;
+                }
+                else
+                {
+                    if (!failed)
+                    {
+                        ost.write(node->buf.data(), static_cast<std::streamsize>(node->buf.size()));
+                        if (!ost)
+                            failed = true;
+                    }
+
+                    node->buf.clear();
+                    node->in_flight = false;
+                    node->in_flight.notify_one();
+                }
 
-private:
-    std::ofstream ost;
-    const char delim;
+                node = next;
+            }
+        }
+    }
 };
 
 // implementations
-void attach_fieldnames(Row& r, const FieldNames* fns, size_type row_num)
+namespace detail {
+inline void check_field_num(const FieldNames* fns, size_type field_num, size_type row_num)
 {
-    r.fns = fns;
-    if (r.fns->size() != r.size())
+    if (fns->size() != field_num)
     {
         std::cout << "CAUTION: Data Inconsistency at line " << row_num
-                  << ": " << r.fns->size() << " fieldnames vs. "
-                  << r.size() << " fields\n";
+                  << ": " << fns->size() << " fieldnames vs. "
+                  << field_num << " fields\n";
     }
 }
+} // namespace detail
+
+void attach_fieldnames(Row& r, const FieldNames* fns, size_type row_num)
+{
+    r.fns = fns;
+    detail::check_field_num(fns, r.size(), row_num);
+}
+
+// RowView keeps no fieldnames and its fields are only checked against them
+inline void attach_fieldnames(const RowView& rv, const FieldNames* fns, size_type row_num)
+{
+    detail::check_field_num(fns, rv.size(), row_num);
+}
 
 std::ostream& operator<<(std::ostream& os, const Row& r)
 {
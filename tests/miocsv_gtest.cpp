@@ -9,11 +9,32 @@
 
 #include <stdcsv.h>
 #include <miocsv.h>
+#include <columncsv.h>
+#include <arrowcsv.h>
+#include <cachecsv.h>
+#ifdef BGZF_TEST_FILE
+#include <bgzfcsv.h>
+#endif
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <span>
+#include <sstream>
 #include <string>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 /**
@@ -311,6 +332,44 @@ bool sniff_cr(const std::string& filename)
     return s.back() == CR;
 }
 
+/**
+ * @brief split a file into parts, each of which has a copy of the header if required
+ */
+std::vector<std::string> split_file(const std::string& filename, miocsv::size_type part_num,
+                                    bool with_header)
+{
+    namespace fs = std::filesystem;
+
+    std::ifstream ist {filename, std::ios::binary};
+    std::vector<std::string> lines;
+    for (std::string s; std::getline(ist, s);)
+        lines.push_back(s);
+
+    auto dir = fs::temp_directory_path()
+               / ("miocsv_parts_" + std::to_string(part_num) + (with_header ? "_h" : ""));
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<std::string> paths;
+    miocsv::size_type first = with_header ? 1 : 0;
+    for (miocsv::size_type k = 0; k != part_num; ++k)
+    {
+        auto path = dir / ("part-" + std::to_string(k) + ".csv");
+        std::ofstream ost {path, std::ios::binary};
+        if (with_header)
+            ost << lines[0] << '\n';
+
+        auto b = first + (lines.size() - first) * k / part_num;
+        auto e = first + (lines.size() - first) * (k + 1) / part_num;
+        for (auto i = b; i != e; ++i)
+            ost << lines[i] << '\n';
+
+        paths.push_back(path.string());
+    }
+
+    return paths;
+}
+
 struct EOLCase {
     std::string filename;
 };
@@ -381,4 +440,1634 @@ TEST(MIOCSVTest, ParseThroughBenchmarkCRLFFile)
     ASSERT_NO_THROW(parse_through_MIODictReader(BENCHMARK_CRLF_FILE));
 }
 
+TEST(MIOCSVTest, ColumnHandles)
+{
+    auto reader = miocsv::MIODictReader {TEST_FILE};
+    std::vector<miocsv::Column> columns;
+    for (const auto& name : PARSED_HEADERS)
+        columns.push_back(reader.column(name));
+
+    ASSERT_THROW(reader.column("mock"), miocsv::NoRecord);
+    ASSERT_EQ(reader.get_fieldnames().find("mock"), miocsv::FieldNames::npos);
+    ASSERT_EQ(reader.get_fieldnames().at("capacity"), 8);
+
+    for (const auto& line : reader)
+    {
+        for (miocsv::size_type i = 0, sz = columns.size(); i != sz; ++i)
+        {
+            ASSERT_EQ(columns[i].get_index(), i);
+            EXPECT_EQ(&line[columns[i]], &line[i]);
+            EXPECT_EQ(line.get_if(columns[i]), &line[i]);
+            EXPECT_EQ(line.find(PARSED_HEADERS[i]), &line[i]);
+        }
+
+        EXPECT_EQ(line.find("mock"), nullptr);
+        EXPECT_EQ(line.get_if(line.size()), nullptr);
+        EXPECT_EQ(line.get_if(miocsv::Column{}), nullptr);
+        ASSERT_THROW(line[miocsv::Column{}], miocsv::NoRecord);
+    }
+
+    // fieldnames are kept in order through rehashing
+    miocsv::FieldNames fns;
+    for (miocsv::size_type i = 0; i != 1000; ++i)
+        fns[std::to_string(i)] = i;
+
+    ASSERT_EQ(fns.size(), 1000);
+    miocsv::size_type i = 0;
+    for (const auto& [name, index] : fns)
+    {
+        ASSERT_EQ(name, std::to_string(i));
+        ASSERT_EQ(index, i);
+        ASSERT_EQ(fns.find(name), i++);
+    }
+
+    // a row from Reader has no fieldnames
+    auto row = miocsv::Row {"1", "2"};
+    ASSERT_THROW(row["1"], miocsv::NoRecord);
+    ASSERT_EQ(row.find("1"), nullptr);
+}
+
+struct Link {
+    std::string name;
+    long link_id;
+    int from_node_id;
+    std::string facility_type;
+    double length;
+    float capacity;
+    bool dir_flag;
+};
+
+void validate_bound_links(const std::vector<Link>& links)
+{
+    ASSERT_EQ(links.size(), 2950);
+
+    auto reader = miocsv::MIODictReader {TEST_FILE};
+    miocsv::size_type i = 0;
+    for (const auto& line : reader)
+    {
+        const auto& link = links[i++];
+        EXPECT_EQ(link.name, line["name"]);
+        EXPECT_EQ(link.link_id, std::stol(line["link_id"]));
+        EXPECT_EQ(link.from_node_id, std::stoi(line["from_node_id"]));
+        EXPECT_EQ(link.facility_type, line["facility_type"]);
+        EXPECT_EQ(link.length, std::stod(line["length"]));
+        EXPECT_EQ(link.capacity, std::stof(line["capacity"]));
+        EXPECT_EQ(link.dir_flag, line["dir_flag"] == "1");
+    }
+}
+
+TEST(MIOCSVTest, BindRecords)
+{
+    auto reader = miocsv::MIODictReader {TEST_FILE};
+    auto links = reader.bind<Link>(&Link::name, "name", &Link::link_id, "link_id",
+                                   &Link::from_node_id, "from_node_id",
+                                   &Link::facility_type, "facility_type", &Link::length, "length",
+                                   &Link::capacity, "capacity", &Link::dir_flag, "dir_flag");
+
+    std::vector<Link> vec;
+    for (const auto& link : links)
+        vec.push_back(link);
+
+    validate_bound_links(vec);
+
+    // headers of every file but the first one are skipped
+    auto dict_reader = miocsv::MultiFileDictReader {split_file(TEST_FILE, 3, true)};
+    validate_bound_links(
+        dict_reader.bind<Link>(&Link::name, 0, &Link::link_id, "link_id", &Link::from_node_id, 2,
+                               &Link::facility_type, "facility_type", &Link::length, "length",
+                               &Link::capacity, "capacity", &Link::dir_flag, "dir_flag")
+            .to_vector());
+
+    ASSERT_THROW(dict_reader.bind<Link>(&Link::name, "mock"), miocsv::NoRecord);
+
+    // fields are converted by indices for readers without headers
+    std::string s {"\"a \"\"b\"\"\",+1,,2.5e1,TRUE\nc,x,-2,.5,0\n"};
+    auto buf_reader = miocsv::BufferReader {s};
+    auto vec2 = buf_reader.bind<Link>(&Link::name, 0, &Link::link_id, 1, &Link::from_node_id, 2,
+                                      &Link::length, 3, &Link::dir_flag, 4, &Link::capacity, 5)
+                    .to_vector();
+
+    ASSERT_EQ(vec2.size(), 2);
+    EXPECT_EQ(vec2[0].name, "a \"b\"");
+    EXPECT_EQ(vec2[0].link_id, 1);
+    EXPECT_EQ(vec2[0].from_node_id, 0);
+    EXPECT_EQ(vec2[0].length, 25);
+    EXPECT_EQ(vec2[0].dir_flag, true);
+    EXPECT_EQ(vec2[0].capacity, 0);
+    EXPECT_EQ(vec2[1].name, "c");
+    // ill-formed
+    EXPECT_EQ(vec2[1].link_id, 0);
+    EXPECT_EQ(vec2[1].from_node_id, -2);
+    EXPECT_EQ(vec2[1].length, 0.5);
+    EXPECT_EQ(vec2[1].dir_flag, false);
+
+    // ragged rows are reported against the headers as iterate() does
+    auto ragged = miocsv::BufferDictReader {"name,link_id\nx,1\ny\n"};
+    testing::internal::CaptureStdout();
+    auto vec3 = ragged.bind<Link>(&Link::name, "name", &Link::link_id, "link_id").to_vector();
+    auto out = testing::internal::GetCapturedStdout();
+
+    ASSERT_EQ(vec3.size(), 2);
+    EXPECT_EQ(vec3[1].name, "y");
+    EXPECT_EQ(vec3[1].link_id, 0);
+    EXPECT_NE(out.find("Data Inconsistency at line 3"), std::string::npos);
+}
+
+TEST(MIOCSVTest, NumericConversion)
+{
+    int i = 0;
+    ASSERT_TRUE(miocsv::from_field("2147483647", i));
+    EXPECT_EQ(i, 2147483647);
+    ASSERT_TRUE(miocsv::from_field("-2147483648", i));
+    EXPECT_EQ(i, -2147483648);
+    ASSERT_TRUE(miocsv::from_field("+12", i));
+    EXPECT_EQ(i, 12);
+    ASSERT_TRUE(miocsv::from_field("\"7\"", i));
+    EXPECT_EQ(i, 7);
+
+    for (auto s : {"2147483648", "-2147483649", "", "-", "+", "1.0", "12a", " 1", "+-1"})
+        EXPECT_FALSE(miocsv::from_field(s, i)) << s;
+
+    // an empty field is taken as it is by strings
+    std::string str {"x"};
+    ASSERT_TRUE(miocsv::from_field("", str));
+    EXPECT_TRUE(str.empty());
+
+    std::int64_t l = 0;
+    ASSERT_TRUE(miocsv::from_field("1234567890123456", l));
+    EXPECT_EQ(l, 1234567890123456);
+    ASSERT_TRUE(miocsv::from_field("-9223372036854775808", l));
+    EXPECT_EQ(l, std::numeric_limits<std::int64_t>::min());
+    EXPECT_FALSE(miocsv::from_field("9223372036854775808", l));
+    EXPECT_FALSE(miocsv::from_field("12345678x0123456", l));
+
+    unsigned short us = 0;
+    EXPECT_FALSE(miocsv::from_field("-1", us));
+    EXPECT_FALSE(miocsv::from_field("65536", us));
+
+    // the fast path shall agree with std::from_chars bit by bit
+    auto check = [](const std::string& s) {
+        double d = 0, expected = 0;
+        auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), expected);
+        ASSERT_EQ(miocsv::from_field(s, d), ec == std::errc {}) << s;
+        if (ec == std::errc {})
+        {
+            EXPECT_EQ(std::memcmp(&d, &expected, sizeof(double)), 0) << s;
+        }
+
+        float f = 0, expected_f = 0;
+        auto [q, ec_f] = std::from_chars(s.data(), s.data() + s.size(), expected_f);
+        ASSERT_EQ(miocsv::from_field(s, f), ec_f == std::errc {}) << s;
+        if (ec_f == std::errc {})
+        {
+            EXPECT_EQ(std::memcmp(&f, &expected_f, sizeof(float)), 0) << s;
+        }
+    };
+
+    for (auto s : {"0", "-0", "0.0", "1", "1.", ".5", "0.86267", "6.10762", "5.96027037e8",
+                   "458544.0", "1e22", "1e23", "9007199254740993", "123456789012345678901",
+                   "2.2250738585072014e-308", "1.7976931348623157e308", "4.9e-324", "1e-400",
+                   "nan", "-inf", "0.1", "0.30000000000000004"})
+        check(s);
+
+    std::srand(42);
+    char buf[64];
+    for (auto k = 0; k != 20000; ++k)
+    {
+        auto v = static_cast<double>(std::rand()) / RAND_MAX * std::pow(10, std::rand() % 40 - 20);
+        for (auto fmt : {"%.17g", "%.6f", "%.3e", "%g"})
+        {
+            std::snprintf(buf, sizeof(buf), fmt, v);
+            check(buf);
+        }
+    }
+
+    bool b = false;
+    ASSERT_TRUE(miocsv::from_field("TRUE", b));
+    EXPECT_TRUE(b);
+    EXPECT_FALSE(miocsv::from_field("yes", b));
+
+    // typed retrieval from rows
+    auto reader = miocsv::MIODictReader {TEST_FILE};
+    auto capacity = reader.column("capacity");
+    for (const auto& line : reader)
+    {
+        EXPECT_EQ(line.get<int>("link_id"), std::stoi(line["link_id"]));
+        EXPECT_EQ(line.get<double>(6), std::stod(line[6]));
+        EXPECT_EQ(line.get<float>(capacity), std::stof(line[capacity]));
+        EXPECT_FALSE(line.get<int>("name"));
+        EXPECT_FALSE(line.get<int>("facility_type"));
+        EXPECT_FALSE(line.get<int>("mock"));
+        EXPECT_FALSE(line.get<int>(line.size()));
+    }
+
+    auto row = miocsv::Row {"1", ""};
+    EXPECT_FALSE(row.get<int>(1));
+    EXPECT_EQ(row.get<std::string>(1), "");
+    EXPECT_FALSE(row.get<std::string>(2));
+}
+
+template<typename T>
+void validate_decoded_column(const std::vector<std::string>& column)
+{
+    std::vector<std::string_view> fields {column.begin(), column.end()};
+    std::vector<T> values;
+    auto failure_num = miocsv::decode_column(fields, values);
+    ASSERT_EQ(values.size(), fields.size());
+
+    miocsv::size_type n = 0;
+    for (miocsv::size_type i = 0; i != fields.size(); ++i)
+    {
+        T v {};
+        if (!miocsv::from_field(fields[i], v))
+        {
+            ++n;
+            EXPECT_EQ(values[i], T {}) << fields[i];
+        }
+        else
+            EXPECT_EQ(std::memcmp(&values[i], &v, sizeof(T)), 0) << fields[i];
+    }
+
+    EXPECT_EQ(failure_num, n);
+}
+
+TEST(MIOCSVTest, DecodeColumns)
+{
+    // rows, cols, sample, timing, bytes
+    std::vector<std::vector<std::string>> columns(5);
+    auto reader = miocsv::MIOReader {BENCHMARK_FILE};
+    for (const auto& line : reader)
+    {
+        if (reader.get_row_num() == 1)
+            continue;
+
+        columns[0].push_back(line[3]);
+        columns[1].push_back(line[4]);
+        columns[2].push_back(line[7]);
+        columns[3].push_back(line[8]);
+        columns[4].push_back(line[9]);
+    }
+
+    for (miocsv::size_type i = 0; i != 3; ++i)
+    {
+        validate_decoded_column<int>(columns[i]);
+        validate_decoded_column<std::uint64_t>(columns[i]);
+        validate_decoded_column<double>(columns[i]);
+    }
+
+    for (miocsv::size_type i = 3; i != 5; ++i)
+    {
+        validate_decoded_column<double>(columns[i]);
+        validate_decoded_column<float>(columns[i]);
+        validate_decoded_column<int>(columns[i]);
+    }
+
+    std::vector<std::string> column {"0", "-0", "+7", "\"42\"", "", "-", ".", "1.", ".5", "-.5",
+                                     "1e5", "nan", "-inf", "12a", "1.2.3", "0.000001",
+                                     "9999999999999999", "99999999999999999", "9007199254740993",
+                                     "-9223372036854775808", "2147483648", "-2147483649",
+                                     "0.1234567890123456", "1234567.123456789012", "3.4e39"};
+
+    std::srand(7);
+    char buf[64];
+    for (auto k = 0; k != 5000; ++k)
+    {
+        auto v = static_cast<double>(std::rand()) / RAND_MAX * std::pow(10, std::rand() % 24 - 12);
+        for (auto fmt : {"%.15g", "%.6f", "%.2f", "%.0f", "%.17g"})
+        {
+            std::snprintf(buf, sizeof(buf), fmt, std::rand() % 2 ? v : -v);
+            column.push_back(buf);
+        }
+    }
+
+    validate_decoded_column<int>(column);
+    validate_decoded_column<std::int64_t>(column);
+    validate_decoded_column<unsigned>(column);
+    validate_decoded_column<double>(column);
+    validate_decoded_column<float>(column);
+}
+
+TEST(MIOCSVTest, ParseDateTimes)
+{
+    using namespace std::chrono;
+
+    sys_time<milliseconds> t;
+    ASSERT_TRUE(miocsv::from_field("2020-05-02T06:13:38.426", t));
+    EXPECT_EQ(t, sys_days {2020y / May / 2} + 6h + 13min + 38s + 426ms);
+    EXPECT_EQ(t.time_since_epoch().count(), 1588400018426);
+
+    ASSERT_TRUE(miocsv::from_field("\"2020-05-02 06:13\"", t));
+    EXPECT_EQ(t, sys_days {2020y / May / 2} + 6h + 13min);
+
+    ASSERT_TRUE(miocsv::from_field("2020-05-02T06:13:38,4269Z", t));
+    EXPECT_EQ(t, sys_days {2020y / May / 2} + 6h + 13min + 38s + 426ms);
+
+    ASSERT_TRUE(miocsv::from_field("2020-05-02T06:13:38+08:00", t));
+    EXPECT_EQ(t, sys_days {2020y / May / 1} + 22h + 13min + 38s);
+
+    ASSERT_TRUE(miocsv::from_field("2020-05-02T06:13:38-0130", t));
+    EXPECT_EQ(t, sys_days {2020y / May / 2} + 7h + 43min + 38s);
+
+    ASSERT_TRUE(miocsv::from_field("2020-05-02T06:13:38-05", t));
+    EXPECT_EQ(t, sys_days {2020y / May / 2} + 11h + 13min + 38s);
+
+    ASSERT_TRUE(miocsv::from_field("1969-12-31T23:59:59.5", t));
+    EXPECT_EQ(t.time_since_epoch().count(), -500);
+
+    sys_time<nanoseconds> ns;
+    ASSERT_TRUE(miocsv::from_field("2020-05-02T06:13:38.123456789", ns));
+    EXPECT_EQ(ns, sys_days {2020y / May / 2} + 6h + 13min + 38s + 123456789ns);
+
+    sys_days d;
+    ASSERT_TRUE(miocsv::from_field("2024-02-29", d));
+    EXPECT_EQ(d, sys_days {2024y / February / 29});
+    ASSERT_TRUE(miocsv::from_field("2020-05-02T23:59:59", d));
+    EXPECT_EQ(d, sys_days {2020y / May / 2});
+
+    sys_seconds s;
+    ASSERT_TRUE(miocsv::from_field("2020-05-02", s));
+    EXPECT_EQ(s, sys_days {2020y / May / 2});
+
+    for (auto f : {"", "2020", "2020-05-2", "2020/05/02", "2021-02-29", "2020-04-31", "2020-00-01",
+                   "2020-05-02T", "2020-05-02X06:13", "2020-05-02T24:00", "2020-05-02T06:60",
+                   "2020-05-02T06:13:3", "2020-05-02T06:13:38.", "2020-05-02T06:13:38+8",
+                   "2020-05-02T06:13:38+08:0", "2020-05-02T06:13:38+24:00", "2020-05-02T06:13:38ZZ",
+                   "2020-05-02T06:13:38 "})
+        EXPECT_FALSE(miocsv::from_field(f, t)) << f;
+
+    // agree with the calendar computed independently, including all the leap years
+    for (auto y = 1900; y != 2101; ++y)
+    {
+        for (auto m = 1u; m != 13; ++m)
+        {
+            char buf[32];
+            std::snprintf(buf, sizeof(buf), "%04d-%02u-%02uT12:34:56", y, m, 28u);
+            ASSERT_TRUE(miocsv::from_field(buf, t)) << buf;
+            EXPECT_EQ(t, sys_days {year {y} / month {m} / 28} + 12h + 34min + 56s) << buf;
+
+            auto last_day = year_month_day_last {year {y}, month_day_last {month {m}}}.day();
+            std::snprintf(buf, sizeof(buf), "%04d-%02u-%02u", y, m, static_cast<unsigned>(last_day) + 1);
+            EXPECT_FALSE(miocsv::from_field(buf, d)) << buf;
+        }
+    }
+
+    auto reader = miocsv::MIODictReader {BENCHMARK_FILE};
+    for (const auto& line : reader)
+    {
+        auto v = line.get<sys_time<milliseconds>>("\"experiment_date\"");
+        ASSERT_TRUE(v) << line[11];
+
+        int y, mo, dd, h, mi, ss, ms;
+        ASSERT_EQ(std::sscanf(line[11].c_str(), "%d-%d-%dT%d:%d:%d.%d", &y, &mo, &dd, &h, &mi, &ss, &ms), 7);
+        EXPECT_EQ(*v, sys_days {year {y} / mo / dd} + hours {h} + minutes {mi} + seconds {ss}
+                          + milliseconds {ms});
+    }
+
+    auto [dates] = miocsv::load_columns<sys_time<microseconds>>(BENCHMARK_FILE, {"\"experiment_date\""});
+    EXPECT_EQ(dates.front(), sys_days {2020y / May / 2} + 6h + 13min + 38s + 426ms);
+}
+
+TEST(MIOCSVTest, LoadColumns)
+{
+    for (miocsv::size_type thread_num : {1, 4})
+    {
+        auto [names, link_ids, from_node_ids, facility_types, lengths, capacities, dir_flags] =
+            miocsv::load_columns<std::string, long, int, std::string, double, float, char>(
+                TEST_FILE,
+                {"name", "link_id", "from_node_id", "facility_type", "length", "capacity", "dir_flag"},
+                ',', thread_num);
+
+        std::vector<Link> links(names.size());
+        for (miocsv::size_type i = 0; i != links.size(); ++i)
+        {
+            links[i] = {names[i], link_ids[i], from_node_ids[i], facility_types[i], lengths[i],
+                        capacities[i], dir_flags[i] != 0};
+        }
+
+        validate_bound_links(links);
+    }
+
+    // a file large enough to be split into chunks
+    auto [rows, timings] =
+        miocsv::load_columns<int, double>(BENCHMARK_FILE, {"\"rows\"", "\"timing\""}, ',', 4);
+
+    auto reader = miocsv::MIODictReader {BENCHMARK_FILE};
+    miocsv::size_type i = 0;
+    for (const auto& line : reader)
+    {
+        ASSERT_LT(i, rows.size());
+        EXPECT_EQ(rows[i], std::stoi(line[3]));
+        EXPECT_EQ(timings[i], line.get<double>(8).value_or(0));
+        ++i;
+    }
+
+    EXPECT_EQ(i, rows.size());
+    EXPECT_EQ(i, timings.size());
+
+    ASSERT_THROW(miocsv::load_columns<int>(TEST_FILE, {"mock"}), miocsv::NoRecord);
+
+    // short rows, ill-formed fields, and no line ending at the end
+    auto path = std::filesystem::temp_directory_path() / "miocsv_columns.csv";
+    {
+        std::ofstream ofs {path};
+        ofs << "a,b\n1,x\n\n2\n3,4.5";
+    }
+
+    auto [a, b] = miocsv::load_columns<int, double>(path.string(), {"a", "b"});
+    EXPECT_EQ(a, (std::vector<int>{1, 0, 2, 3}));
+    EXPECT_EQ(b, (std::vector<double>{0, 0, 0, 4.5}));
+    std::filesystem::remove(path);
+}
+
+TEST(MIOCSVTest, InferSchema)
+{
+    using miocsv::ColumnType;
+
+    EXPECT_EQ(miocsv::infer_type(""), ColumnType::Null);
+    EXPECT_EQ(miocsv::infer_type("False"), ColumnType::Boolean);
+    EXPECT_EQ(miocsv::infer_type("1"), ColumnType::Integer);
+    EXPECT_EQ(miocsv::infer_type("\"-12\""), ColumnType::Integer);
+    EXPECT_EQ(miocsv::infer_type("99999999999999999999"), ColumnType::Float);
+    EXPECT_EQ(miocsv::infer_type("1e-3"), ColumnType::Float);
+    EXPECT_EQ(miocsv::infer_type("2020-05-02"), ColumnType::Date);
+    EXPECT_EQ(miocsv::infer_type("2020-13-02"), ColumnType::String);
+    EXPECT_EQ(miocsv::infer_type("2020-05-02T06:13:38.426"), ColumnType::DateTime);
+    EXPECT_EQ(miocsv::infer_type("2020-05-02 06:13"), ColumnType::DateTime);
+    EXPECT_EQ(miocsv::infer_type("2020-05-02T06:13:38Z"), ColumnType::DateTime);
+    EXPECT_EQ(miocsv::infer_type("2020-05-02T06:13:38+08:00"), ColumnType::DateTime);
+    EXPECT_EQ(miocsv::infer_type("2020-05-02T24:13:38"), ColumnType::String);
+    EXPECT_EQ(miocsv::infer_type("2020-05-02T06:13:38."), ColumnType::String);
+    EXPECT_EQ(miocsv::infer_type("Highway"), ColumnType::String);
+
+    EXPECT_EQ(miocsv::merge_types(ColumnType::Null, ColumnType::Integer), ColumnType::Integer);
+    EXPECT_EQ(miocsv::merge_types(ColumnType::Float, ColumnType::Integer), ColumnType::Float);
+    EXPECT_EQ(miocsv::merge_types(ColumnType::Date, ColumnType::DateTime), ColumnType::DateTime);
+    EXPECT_EQ(miocsv::merge_types(ColumnType::Boolean, ColumnType::Integer), ColumnType::String);
+    EXPECT_EQ(miocsv::merge_types(ColumnType::Date, ColumnType::Float), ColumnType::String);
+
+    auto schema = miocsv::infer_schema(TEST_FILE);
+    EXPECT_EQ(schema.size(), 22);
+    EXPECT_EQ(schema.get_sample_num(), 1000);
+    EXPECT_EQ(schema[0].name, "name");
+    EXPECT_EQ(schema["name"].type, ColumnType::Null);
+    EXPECT_TRUE(schema["name"].nullable);
+    EXPECT_EQ(schema["link_id"].type, ColumnType::Integer);
+    EXPECT_FALSE(schema["link_id"].nullable);
+    EXPECT_EQ(schema["facility_type"].type, ColumnType::String);
+    EXPECT_EQ(schema["facility_type"].max_width, 7);
+    EXPECT_TRUE(schema["facility_type"].encoded);
+    EXPECT_FALSE(schema["link_id"].encoded);
+    EXPECT_EQ(schema["length"].type, ColumnType::Float);
+    EXPECT_EQ(schema["VDF_alpha1"].type, ColumnType::Float);
+    ASSERT_THROW(schema["mock"], miocsv::NoRecord);
+    ASSERT_THROW(schema[22], miocsv::NoRecord);
+
+    for (auto random : {false, true})
+    {
+        auto bm_schema = miocsv::infer_schema(BENCHMARK_FILE, 500, ',', random);
+        EXPECT_EQ(bm_schema.get_sample_num(), 500);
+        EXPECT_EQ(bm_schema["\"runid\""].type, ColumnType::String);
+        EXPECT_EQ(bm_schema["\"attempt\""].type, ColumnType::String);
+        EXPECT_EQ(bm_schema["\"rows\""].type, ColumnType::Integer);
+        EXPECT_EQ(bm_schema["\"withna\""].type, ColumnType::Boolean);
+        EXPECT_EQ(bm_schema["\"timing\""].type, ColumnType::Float);
+        EXPECT_EQ(bm_schema["\"experiment_date\""].type, ColumnType::DateTime);
+        EXPECT_EQ(bm_schema["\"experiment_date\""].max_width, 23);
+    }
+
+    // the typed loader takes the schema
+    auto bm_schema = miocsv::infer_schema(BENCHMARK_FILE);
+    auto columns = miocsv::load_columns(BENCHMARK_FILE, bm_schema);
+    ASSERT_EQ(columns.size(), bm_schema.size());
+
+    const auto& runids = std::get<miocsv::EncodedColumn>(columns[0]);
+    const auto& rows = std::get<std::vector<std::int64_t>>(columns[3]);
+    const auto& withnas = std::get<std::vector<char>>(columns[5]);
+    const auto& timings = std::get<std::vector<double>>(columns[8]);
+    const auto& dates = std::get<std::vector<miocsv::Timestamp>>(columns[11]);
+
+    auto reader = miocsv::MIODictReader {BENCHMARK_FILE};
+    miocsv::size_type i = 0;
+    for (const auto& line : reader)
+    {
+        ASSERT_LT(i, rows.size());
+        EXPECT_EQ(runids[i], "master");
+        EXPECT_EQ(rows[i], std::stol(line[3]));
+        EXPECT_EQ(withnas[i], line[5] == "true");
+        EXPECT_EQ(timings[i], std::stod(line[8]));
+        EXPECT_EQ(dates[i], line.get<miocsv::Timestamp>(11));
+        ++i;
+    }
+
+    EXPECT_EQ(i, rows.size());
+    EXPECT_EQ(runids.size(), rows.size());
+    EXPECT_EQ(runids.dictionary.size(), 1);
+
+    // opt out of dictionary encoding
+    bm_schema["\"runid\""].encoded = false;
+    auto unencoded = miocsv::load_columns(BENCHMARK_FILE, bm_schema);
+    EXPECT_EQ(std::get<std::vector<std::string>>(unencoded[0]).size(), rows.size());
+}
+
+TEST(MIOCSVTest, DictionaryEncoding)
+{
+    miocsv::Dictionary dict;
+    EXPECT_TRUE(dict.empty());
+    EXPECT_EQ(dict.encode("Highway"), 0);
+    EXPECT_EQ(dict.encode("Arterial"), 1);
+    EXPECT_EQ(dict.encode("Highway"), 0);
+    EXPECT_EQ(dict.size(), 2);
+    EXPECT_EQ(dict.find("Arterial"), 1);
+    EXPECT_EQ(dict.find("Ramp"), miocsv::Dictionary::npos);
+    EXPECT_EQ(dict[1], "Arterial");
+    EXPECT_EQ(dict.decode(0), "Highway");
+    ASSERT_THROW(dict.decode(2), std::out_of_range);
+    dict.clear();
+    EXPECT_TRUE(dict.empty());
+
+    for (miocsv::size_type thread_num : {1, 4})
+    {
+        auto [link_ids, facility_types] = miocsv::load_columns<long, miocsv::Dictionary>(
+            TEST_FILE, {"link_id", "facility_type"}, ',', thread_num);
+
+        ASSERT_EQ(facility_types.size(), link_ids.size());
+        EXPECT_EQ(facility_types.dictionary.size(), 1);
+        for (miocsv::size_type i = 0; i != facility_types.size(); ++i)
+            EXPECT_EQ(facility_types[i], "Highway");
+    }
+
+    // codes follow the first appearance of values regardless of the number of threads
+    auto [packages1] = miocsv::load_columns<miocsv::Dictionary>(BENCHMARK_FILE, {"\"package\""}, ',', 1);
+    auto [packages4] = miocsv::load_columns<miocsv::Dictionary>(BENCHMARK_FILE, {"\"package\""}, ',', 4);
+    EXPECT_EQ(packages1.codes, packages4.codes);
+    EXPECT_EQ(packages4.dictionary.size(), packages1.dictionary.size());
+
+    auto reader = miocsv::MIODictReader {BENCHMARK_FILE};
+    miocsv::Dictionary expected;
+    miocsv::size_type i = 0;
+    for (const auto& line : reader)
+    {
+        ASSERT_LT(i, packages4.size());
+        EXPECT_EQ(packages4.codes[i], expected.encode(miocsv::unquote(line[6])));
+        EXPECT_EQ(packages4[i], miocsv::unquote(line[6]));
+        ++i;
+    }
+
+    EXPECT_EQ(i, packages4.size());
+    EXPECT_EQ(expected.size(), packages4.dictionary.size());
+
+    // quoted fields are unescaped
+    auto path = std::filesystem::temp_directory_path() / "miocsv_encoding.csv";
+    {
+        std::ofstream ofs {path};
+        ofs << "a\nx\n\"x\"\n\"y \"\"z\"\"\"\n\nx";
+    }
+
+    auto [a] = miocsv::load_columns<miocsv::Dictionary>(path.string(), {"a"});
+    EXPECT_EQ(a.codes, (std::vector<miocsv::Dictionary::code_type>{0, 0, 1, 2, 0}));
+    EXPECT_EQ(a[2], "y \"z\"");
+    EXPECT_EQ(a[3], "");
+
+    // null tokens are encoded as empty strings with no bitmap, as StringColumn takes them
+    {
+        std::ofstream ofs {path};
+        ofs << "a\nx\nNA\n\"NA\"\n\ny\n";
+    }
+
+    auto [b, c] = miocsv::load_columns<miocsv::Dictionary, std::string_view>(
+        path.string(), {"a", "a"}, ',', 0, {"", "NA"});
+    EXPECT_EQ(b.codes, (std::vector<miocsv::Dictionary::code_type>{0, 1, 1, 1, 2}));
+    EXPECT_EQ(b.dictionary.find("NA"), miocsv::Dictionary::npos);
+    for (miocsv::size_type i = 0; i != c.size(); ++i)
+        EXPECT_EQ(b[i], c[i]);
+
+    std::filesystem::remove(path);
+}
+
+TEST(MIOCSVTest, NullValues)
+{
+    miocsv::NullTokens nulls {"", "NA", "NaN"};
+    EXPECT_TRUE(nulls.contains(""));
+    EXPECT_TRUE(nulls.contains("\"NA\""));
+    EXPECT_FALSE(nulls.contains("N"));
+    EXPECT_TRUE(miocsv::NullTokens{}.contains(""));
+    EXPECT_FALSE(miocsv::NullTokens{}.contains("NA"));
+
+    miocsv::ValidityBitmap bitmap;
+    bitmap.assign(10);
+    EXPECT_EQ(bitmap.null_count(), 0);
+    EXPECT_EQ(bitmap.data()[1], 0x03);
+    bitmap.set_null(9);
+    bitmap.set(0, false);
+    EXPECT_EQ(bitmap.null_count(), 2);
+    EXPECT_EQ(bitmap.data()[0], 0xFE);
+    EXPECT_FALSE(bitmap[9]);
+    EXPECT_TRUE(bitmap[8]);
+
+    // NaN in bytes
+    for (miocsv::size_type thread_num : {1, 4})
+    {
+        auto [rows, bytes] = miocsv::load_columns<long, miocsv::Nullable<double>>(
+            BENCHMARK_FILE, {"\"rows\"", "\"bytes\""}, ',', thread_num, nulls);
+
+        auto reader = miocsv::MIODictReader {BENCHMARK_FILE};
+        miocsv::size_type i = 0, null_num = 0;
+        for (const auto& line : reader)
+        {
+            ASSERT_LT(i, bytes.size());
+            if (line[9] == "NaN")
+            {
+                EXPECT_TRUE(bytes.is_null(i));
+                EXPECT_EQ(bytes.values[i], 0);
+                ++null_num;
+            }
+            else
+            {
+                EXPECT_FALSE(bytes.is_null(i));
+                EXPECT_EQ(bytes.values[i], std::stod(line[9]));
+            }
+            ++i;
+        }
+
+        EXPECT_EQ(i, rows.size());
+        EXPECT_EQ(bytes.validity.size(), i);
+        EXPECT_EQ(bytes.validity.null_count(), null_num);
+        EXPECT_GT(null_num, 0);
+    }
+
+    // nulls of all kinds, with no warning on them
+    auto path = std::filesystem::temp_directory_path() / "miocsv_nulls.csv";
+    {
+        std::ofstream ofs {path};
+        ofs << "a,b,c,d\n1,x,true,2020-05-02\nNA,NA,NA,NA\n,,,\n3,\"NA\",false\n";
+    }
+
+    auto [a, b, c] = miocsv::load_columns<miocsv::Nullable<int>, miocsv::Nullable<std::string>,
+                                          miocsv::Nullable<miocsv::Dictionary>>(
+        path.string(), {"a", "b", "c"}, ',', 0, nulls);
+
+    EXPECT_EQ(a.values, (std::vector<int>{1, 0, 0, 3}));
+    EXPECT_EQ(a.validity.null_count(), 2);
+    EXPECT_TRUE(a.is_null(1));
+    EXPECT_EQ(b.values, (std::vector<std::string>{"x", "", "", ""}));
+    EXPECT_EQ(b.validity.null_count(), 3);
+    EXPECT_EQ(c.values.size(), 4);
+    EXPECT_EQ(c.values[3], "false");
+    EXPECT_EQ(c.validity.null_count(), 2);
+
+    auto schema = miocsv::infer_schema(path.string(), 1000, ',', false, nulls);
+    EXPECT_EQ(schema["a"].type, miocsv::ColumnType::Integer);
+    EXPECT_EQ(schema["c"].type, miocsv::ColumnType::Boolean);
+    EXPECT_EQ(schema["d"].type, miocsv::ColumnType::Date);
+    EXPECT_TRUE(schema["d"].nullable);
+
+    auto table = miocsv::load_table(path.string(), schema, ',', 0, nulls);
+    ASSERT_EQ(table.columns.size(), 4);
+    EXPECT_EQ(table.row_num(), 4);
+    EXPECT_EQ(std::get<std::vector<std::int64_t>>(table.columns[0]), (std::vector<std::int64_t>{1, 0, 0, 3}));
+    EXPECT_EQ(std::get<std::vector<char>>(table.columns[2]), (std::vector<char>{1, 0, 0, 0}));
+    EXPECT_EQ(table.validity[2].null_count(), 2);
+    EXPECT_EQ(table.validity[3].null_count(), 3);
+    EXPECT_TRUE(table.validity[3][0]);
+
+    // fields beyond the headers of a ragged file are left out of the schema
+    {
+        std::ofstream ofs {path};
+        ofs << "a,b\n1,x\n2,y,extra\n3\n";
+    }
+
+    schema = miocsv::infer_schema(path.string());
+    ASSERT_EQ(schema.size(), 2);
+    EXPECT_TRUE(schema["b"].nullable);
+    ASSERT_THROW(schema[2], miocsv::NoRecord);
+
+    table = miocsv::load_table(path.string(), schema);
+    ASSERT_EQ(table.columns.size(), 2);
+    EXPECT_EQ(table.row_num(), 3);
+    EXPECT_EQ(std::get<std::vector<std::int64_t>>(table.columns[0]), (std::vector<std::int64_t>{1, 2, 3}));
+    std::filesystem::remove(path);
+}
+
+TEST(MIOCSVTest, ArrowExport)
+{
+    auto path = std::filesystem::temp_directory_path() / "miocsv_arrow.csv";
+    {
+        std::ofstream ofs {path};
+        ofs << "\"id\",score,flag,day,at,note,kind\n"
+            << "1,1.5,true,2020-05-02,2020-05-02T06:13:38,x,A\n"
+            << "2,NA,false,1970-01-02,1970-01-01T00:00:01.5,\"y \"\"z\"\"\",B\n"
+            << "3,-2,,,,,A\n"
+            << "4,0,true,1969-12-31,1970-01-01,w,A\n";
+    }
+
+    miocsv::NullTokens nulls {"", "NA"};
+    auto schema = miocsv::infer_schema(path.string(), 1000, ',', false, nulls);
+    schema["note"].encoded = false;
+    ASSERT_TRUE(schema["kind"].encoded);
+
+    ArrowArray array;
+    ArrowSchema arrow_schema;
+    miocsv::load_arrow(path.string(), schema, &array, &arrow_schema, ',', 0, nulls);
+
+    ASSERT_NE(array.release, nullptr);
+    ASSERT_NE(arrow_schema.release, nullptr);
+    EXPECT_STREQ(arrow_schema.format, "+s");
+    EXPECT_EQ(array.length, 4);
+    ASSERT_EQ(array.n_children, 7);
+    ASSERT_EQ(arrow_schema.n_children, 7);
+
+    const char* formats[] {"l", "g", "b", "tdD", "tsu:", "U", "i"};
+    const char* names[] {"id", "score", "flag", "day", "at", "note", "kind"};
+    for (int j = 0; j != 7; ++j)
+    {
+        EXPECT_STREQ(arrow_schema.children[j]->format, formats[j]);
+        EXPECT_STREQ(arrow_schema.children[j]->name, names[j]);
+        EXPECT_EQ(array.children[j]->length, 4);
+    }
+
+    auto* ids = array.children[0];
+    EXPECT_EQ(ids->null_count, 0);
+    EXPECT_EQ(ids->buffers[0], nullptr);
+    EXPECT_EQ(static_cast<const std::int64_t*>(ids->buffers[1])[3], 4);
+
+    auto* scores = array.children[1];
+    EXPECT_EQ(scores->null_count, 1);
+    EXPECT_EQ(static_cast<const std::uint8_t*>(scores->buffers[0])[0], 0x0D);
+    EXPECT_EQ(static_cast<const double*>(scores->buffers[1])[2], -2);
+
+    auto* flags = array.children[2];
+    EXPECT_EQ(flags->null_count, 1);
+    EXPECT_EQ(static_cast<const std::uint8_t*>(flags->buffers[1])[0], 0x09);
+
+    auto* days = static_cast<const std::int32_t*>(array.children[3]->buffers[1]);
+    EXPECT_EQ(days[1], 1);
+    EXPECT_EQ(days[3], -1);
+
+    auto* ats = static_cast<const std::int64_t*>(array.children[4]->buffers[1]);
+    EXPECT_EQ(ats[1], 1500000);
+
+    auto* notes = array.children[5];
+    ASSERT_EQ(notes->n_buffers, 3);
+    EXPECT_EQ(notes->null_count, 1);
+    auto* offsets = static_cast<const std::int64_t*>(notes->buffers[1]);
+    auto* chars = static_cast<const char*>(notes->buffers[2]);
+    EXPECT_EQ(std::string_view(chars + offsets[1], offsets[2] - offsets[1]), "y \"z\"");
+    EXPECT_EQ(offsets[2], offsets[3]);
+    EXPECT_EQ(offsets[4], 7);
+
+    // move a child out, which outlives its parent
+    ArrowArray kinds = *array.children[6];
+    array.children[6]->release = nullptr;
+    ASSERT_NE(arrow_schema.children[6]->dictionary, nullptr);
+    EXPECT_STREQ(arrow_schema.children[6]->dictionary->format, "U");
+
+    array.release(&array);
+    arrow_schema.release(&arrow_schema);
+    EXPECT_EQ(array.release, nullptr);
+    EXPECT_EQ(arrow_schema.release, nullptr);
+
+    auto* codes = static_cast<const std::uint32_t*>(kinds.buffers[1]);
+    EXPECT_EQ(std::vector<std::uint32_t>(codes, codes + 4), (std::vector<std::uint32_t>{0, 1, 0, 0}));
+    ASSERT_NE(kinds.dictionary, nullptr);
+    EXPECT_EQ(kinds.dictionary->length, 2);
+    auto* dict_chars = static_cast<const char*>(kinds.dictionary->buffers[2]);
+    EXPECT_EQ(std::string_view(dict_chars, 2), "AB");
+    kinds.release(&kinds);
+    EXPECT_EQ(kinds.release, nullptr);
+
+    // a whole file in parallel
+    auto bm_schema = miocsv::infer_schema(BENCHMARK_FILE);
+    bm_schema["\"attempt\""].encoded = false;
+    miocsv::load_arrow(BENCHMARK_FILE, bm_schema, &array, &arrow_schema, ',', 4);
+    auto columns = miocsv::load_columns(BENCHMARK_FILE, bm_schema);
+    const auto& attempts = std::get<std::vector<std::string>>(columns[1]);
+    ASSERT_EQ(array.length, static_cast<std::int64_t>(attempts.size()));
+
+    offsets = static_cast<const std::int64_t*>(array.children[1]->buffers[1]);
+    chars = static_cast<const char*>(array.children[1]->buffers[2]);
+    for (miocsv::size_type i = 0; i != attempts.size(); ++i)
+        EXPECT_EQ(std::string_view(chars + offsets[i], offsets[i + 1] - offsets[i]), attempts[i]);
+
+    array.release(&array);
+    arrow_schema.release(&arrow_schema);
+    std::filesystem::remove(path);
+}
+
+TEST(MIOCSVTest, ColumnCache)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_cache.csv").string();
+    auto cpath = miocsv::cache_path(path);
+    std::filesystem::copy_file(BENCHMARK_FILE, path, std::filesystem::copy_options::overwrite_existing);
+    std::filesystem::remove(cpath);
+
+    miocsv::NullTokens nulls {"", "NaN"};
+    auto schema = miocsv::infer_schema(path, 1000, ',', false, nulls);
+    auto table = miocsv::load_table(path, schema, ',', 0, nulls);
+
+    // the first open builds the cache
+    auto cache = miocsv::open_cache(path, schema, ',', 0, nulls);
+    ASSERT_TRUE(std::filesystem::exists(cpath));
+    EXPECT_TRUE(cache.matches(path, schema, ',', nulls));
+    EXPECT_FALSE(cache.matches(path, schema, ',', {}));
+    EXPECT_EQ(cache.row_num(), table.row_num());
+    ASSERT_EQ(cache.size(), schema.size());
+    EXPECT_EQ(cache.get_name(3), "\"rows\"");
+
+    auto rows = cache.values<std::int64_t>(3);
+    EXPECT_EQ(std::vector<std::int64_t>(rows.begin(), rows.end()),
+              std::get<std::vector<std::int64_t>>(table.columns[3]));
+    auto bytes = cache.values<double>(9);
+    const auto& expected_bytes = std::get<std::vector<double>>(table.columns[9]);
+    for (miocsv::size_type i = 0; i != table.row_num(); ++i)
+    {
+        EXPECT_EQ(cache.is_null(9, i), !table.validity[9][i]);
+        EXPECT_EQ(bytes[i], expected_bytes[i]);
+    }
+
+    auto attempts = cache.strings(1);
+    const auto& expected_attempts = std::get<miocsv::EncodedColumn>(table.columns[1]);
+    ASSERT_EQ(attempts.size(), expected_attempts.dictionary.size());
+    auto codes = cache.values<miocsv::Dictionary::code_type>(1);
+    for (miocsv::size_type i = 0; i != table.row_num(); ++i)
+        EXPECT_EQ(attempts[codes[i]], expected_attempts[i]);
+
+    ASSERT_THROW(cache.values<double>(3), std::bad_variant_access);
+    ASSERT_THROW(cache.strings(3), std::bad_variant_access);
+
+    auto copied = cache.to_table(schema);
+    ASSERT_EQ(copied.columns.size(), table.columns.size());
+    EXPECT_EQ(std::get<std::vector<miocsv::Timestamp>>(copied.columns[11]),
+              std::get<std::vector<miocsv::Timestamp>>(table.columns[11]));
+    EXPECT_EQ(std::get<std::vector<char>>(copied.columns[5]), std::get<std::vector<char>>(table.columns[5]));
+    EXPECT_EQ(std::get<miocsv::EncodedColumn>(copied.columns[1]).codes, expected_attempts.codes);
+    EXPECT_EQ(copied.validity[9].null_count(), table.validity[9].null_count());
+
+    // the second open takes the cache as it is
+    auto written = std::filesystem::last_write_time(cpath);
+    auto cache2 = miocsv::open_cache(path, schema, ',', 0, nulls);
+    EXPECT_EQ(std::filesystem::last_write_time(cpath), written);
+    EXPECT_EQ(cache2.row_num(), table.row_num());
+
+    // a changed source or schema is rebuilt
+    {
+        std::ofstream ofs {path, std::ios::app};
+        ofs << "\"master\",\"first\",\"x\",1,1,true,\"p\",1,0.5,1,\"q\",2020-05-02T06:13:38.426\n";
+    }
+
+    auto cache3 = miocsv::open_cache(path, schema, ',', 0, nulls);
+    EXPECT_EQ(cache3.row_num(), table.row_num() + 1);
+
+    schema["\"attempt\""].encoded = false;
+    EXPECT_FALSE(cache3.matches(path, schema, ',', nulls));
+    auto cache4 = miocsv::open_cache(path, schema, ',', 0, nulls);
+    EXPECT_EQ(cache4.strings(1)[0], expected_attempts[0]);
+    EXPECT_EQ(std::get<miocsv::StringColumn>(cache4.to_table(schema).columns[1])[0], expected_attempts[0]);
+
+    // a truncated cache is never mapped as it is but rebuilt
+    auto size = std::filesystem::file_size(cpath);
+    std::filesystem::resize_file(cpath, size - 64);
+    EXPECT_FALSE(miocsv::CachedTable::try_open(cpath));
+    auto cache5 = miocsv::open_cache(path, schema, ',', 0, nulls);
+    EXPECT_EQ(std::filesystem::file_size(cpath), size);
+    EXPECT_EQ(cache5.row_num(), table.row_num() + 1);
+
+    // a cache failed to be written is reported
+    std::filesystem::remove(cpath);
+    std::filesystem::create_directory(cpath + ".tmp");
+    std::ofstream {cpath + ".tmp/blocker"};
+    EXPECT_FALSE(miocsv::write_cache(table, path, ',', nulls));
+    ASSERT_THROW(miocsv::open_cache(path, schema, ',', 0, nulls), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(cpath));
+    EXPECT_FALSE(miocsv::CachedTable::try_open(cpath));
+
+    std::filesystem::remove_all(cpath + ".tmp");
+
+    // a source changed while being loaded leaves the cache stale as it is stamped before
+    auto stamp = miocsv::detail::stamp_source(path);
+    {
+        std::ofstream ofs {path, std::ios::app};
+        ofs << "\"master\",\"first\",\"y\",2,1,true,\"p\",1,0.5,1,\"q\",2020-05-02T06:13:38.426\n";
+    }
+
+    ASSERT_TRUE(miocsv::write_cache(table, path, stamp, ',', nulls));
+    EXPECT_FALSE(miocsv::CachedTable {cpath}.matches(path, schema, ',', nulls));
+    EXPECT_EQ(miocsv::open_cache(path, schema, ',', 0, nulls).row_num(), table.row_num() + 2);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(cpath);
+}
+
+TEST(MIOCSVTest, RowFromValues)
+{
+    auto r = miocsv::Row {"link", std::string {"id"}, std::string_view {"sv"}, 'c', true, -42,
+                          std::numeric_limits<std::uint64_t>::max(), 0.1, 1.0 / 3, 2.5f, 1e100,
+                          miocsv::with_precision(1.0 / 3, 3), miocsv::with_precision(1234567.0, 2)};
+    ASSERT_EQ(r.size(), 13);
+    EXPECT_EQ(r[0], "link");
+    EXPECT_EQ(r[1], "id");
+    EXPECT_EQ(r[2], "sv");
+    EXPECT_EQ(r[3], "c");
+    EXPECT_EQ(r[4], "1");
+    EXPECT_EQ(r[5], "-42");
+    EXPECT_EQ(r[6], "18446744073709551615");
+    EXPECT_EQ(r[7], "0.1");
+    EXPECT_EQ(std::stod(r[8]), 1.0 / 3);
+    EXPECT_EQ(r[9], "2.5");
+    EXPECT_EQ(r[10], "1e+100");
+    EXPECT_EQ(r[11], "0.333");
+    EXPECT_EQ(r[12], "1.2e+06");
+
+    // others still go through operator<<
+    std::ostringstream os;
+    os << std::chrono::seconds {5};
+    EXPECT_EQ(miocsv::Row {std::chrono::seconds {5}}[0], os.str());
+    compare(miocsv::Row {std::uint8_t {'u'}, std::int8_t {'i'}}, {"u", "i"});
+
+    // the precision of a value overrides the one of the writer
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_precision.csv").string();
+    {
+        auto writer = miocsv::Writer {path};
+        writer.set_precision(2);
+        writer.write_row_raw(1.0 / 3, miocsv::with_precision(1.0 / 3, 4));
+    }
+
+    auto line = *miocsv::Reader {path}.begin();
+    EXPECT_EQ(line[0], "0.33");
+    EXPECT_EQ(line[1], "0.3333");
+    std::filesystem::remove(path);
+}
+
+TEST(MIOCSVTest, WriteRows)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_writer.csv").string();
+    {
+        auto writer = miocsv::Writer {path};
+        writer.write_row({"a, b", "c", 1, 2.5});
+        writer.write_row_raw("d", -3, 0.1, true, 'x', std::int8_t {'y'}, static_cast<unsigned char>('z'));
+        writer.append(1e21);
+        writer.append(std::numeric_limits<double>::max(), '\n');
+
+        writer.set_precision(3);
+        EXPECT_EQ(writer.get_precision(), 3);
+        writer.write_row_raw(3.14159, 2.0f / 3, 1234567.0);
+
+        // more than a buffer to flush on the way
+        for (miocsv::size_type i = 0; i != miocsv::BaseWriter::BUFFER_SIZE / 8; ++i)
+            writer.append(i, '\n');
+    }
+
+    auto reader = miocsv::Reader {path};
+    auto it = reader.begin();
+    EXPECT_EQ((*it)[0], "\"a, b\"");
+    EXPECT_EQ((*it)[3], "2.5");
+    ++it;
+    ASSERT_EQ((*it).size(), 7);
+    EXPECT_EQ((*it)[1], "-3");
+    EXPECT_EQ((*it)[2], "0.1");
+    EXPECT_EQ((*it)[3], "1");
+    EXPECT_EQ((*it)[4], "x");
+    // char types are written as chars as operator<< does
+    EXPECT_EQ((*it)[5], "y");
+    EXPECT_EQ((*it)[6], "z");
+    ++it;
+    EXPECT_EQ((*it)[0], "1e+21");
+    EXPECT_EQ(std::stod((*it)[1]), std::numeric_limits<double>::max());
+    ++it;
+    EXPECT_EQ((*it)[0], "3.14");
+    EXPECT_EQ((*it)[1], "0.667");
+    EXPECT_EQ((*it)[2], "1.23e+06");
+
+    miocsv::size_type i = 0;
+    for (++it; it != reader.end(); ++it, ++i)
+        ASSERT_EQ((*it)[0], std::to_string(i));
+
+    EXPECT_EQ(i, miocsv::BaseWriter::BUFFER_SIZE / 8);
+
+    // records with quotes or line breaks are quoted and escaped
+    {
+        auto writer = miocsv::Writer {path};
+        writer.write_row({"say \"hi\"", "two\nlines", "cr\r", "", "\"", "a long record with no special chars"});
+    }
+
+    std::ifstream ist {path};
+    std::string written {std::istreambuf_iterator<char>{ist}, std::istreambuf_iterator<char>{}};
+    EXPECT_EQ(written, "\"say \"\"hi\"\"\",\"two\nlines\",\"cr\r\",,\"\"\"\",a long record with no special chars\n");
+
+    // the special char at any position of records of any length
+    for (miocsv::size_type n = 1; n != 20; ++n)
+    {
+        for (miocsv::size_type k = 0; k != n; ++k)
+        {
+            for (auto c : {',', '"', '\r', '\n'})
+            {
+                std::string s(n, 'a');
+                s[k] = c;
+                EXPECT_TRUE(miocsv::detail::needs_quoting(s, ','));
+            }
+        }
+
+        EXPECT_FALSE(miocsv::detail::needs_quoting(std::string(n, 'a'), ','));
+        EXPECT_TRUE(miocsv::detail::needs_quoting(std::string(n, ';'), ';'));
+        EXPECT_FALSE(miocsv::detail::needs_quoting(std::string(n, ','), ';'));
+    }
+
+    std::filesystem::remove(path);
+
+    // a failure on writing is reported rather than ignored
+    auto writer = miocsv::Writer {"/dev/full"};
+    writer.write_row_raw("no", "space", "left");
+    ASSERT_THROW(writer.flush(), std::runtime_error);
+}
+
+TEST(MIOCSVTest, WriteColumnsAndRows)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_columns.csv").string();
+    auto read_all = [&path]() {
+        std::ifstream ist {path, std::ios::binary};
+        return std::string {std::istreambuf_iterator<char>{ist}, std::istreambuf_iterator<char>{}};
+    };
+
+    std::vector<int> ids {1, 2, 3};
+    std::vector<double> lengths {0.5, 1.25, 1e-3};
+    std::vector<std::string> names {"a", "b, c", "say \"d\""};
+    std::array<char, 3> flags {'T', ',', '"'};
+    {
+        auto writer = miocsv::Writer {path};
+        writer.write_columns({"id", "length", "name", "flag"}, ids, lengths, names, std::span {flags});
+    }
+
+    // single chars are escaped as well
+    EXPECT_EQ(read_all(), "id,length,name,flag\n1,0.5,a,T\n2,1.25,\"b, c\",\",\"\n3,0.001,\"say \"\"d\"\"\",\"\"\"\"\n");
+
+    // no header and the shortest column
+    {
+        auto writer = miocsv::Writer {path, ';'};
+        writer.write_columns({}, ids, std::vector<std::string_view> {"x;y", "z"});
+    }
+
+    EXPECT_EQ(read_all(), "1;\"x;y\"\n2;z\n");
+
+    // the columns loaded, e.g., StringColumn with the quotes removed
+    auto cols = miocsv::load_columns<std::int64_t, std::string_view>(BENCHMARK_FILE, {"\"rows\"", "\"file\""});
+    {
+        auto writer = miocsv::Writer {path};
+        writer.write_columns({"rows", "file"}, std::get<0>(cols), std::get<1>(cols));
+    }
+
+    miocsv::size_type i = 0;
+    for (const auto& line : miocsv::Reader {path})
+    {
+        if (i)
+        {
+            ASSERT_EQ(line[0], std::to_string(std::get<0>(cols)[i - 1]));
+            ASSERT_EQ(line[1], std::get<1>(cols)[i - 1]);
+        }
+
+        ++i;
+    }
+
+    EXPECT_EQ(i, std::get<0>(cols).size() + 1);
+
+    std::vector<std::tuple<int, std::string, double>> tuples {{1, "a", 0.5}, {2, "b,c", 2.0}};
+    std::vector<std::pair<std::string_view, bool>> pairs {{"x", true}};
+    std::vector<miocsv::Row> rows {{"r", "s,t"}};
+    {
+        auto writer = miocsv::Writer {path};
+        writer.write_rows(tuples);
+        writer.write_rows(pairs);
+        writer.write_rows(rows);
+    }
+
+    EXPECT_EQ(read_all(), "1,a,0.5\n2,\"b,c\",2\nx,1\nr,\"s,t\"\n");
+
+    // and from ConcurrentWriter
+    {
+        auto writer = miocsv::ConcurrentWriter {path};
+        writer.write_columns({"id", "name"}, ids, names);
+        writer.write_rows(tuples);
+    }
+
+    EXPECT_EQ(read_all(), "id,name\n1,a\n2,\"b, c\"\n3,\"say \"\"d\"\"\"\n1,a,0.5\n2,\"b,c\",2\n");
+    std::filesystem::remove(path);
+}
+
+TEST(MIOCSVTest, AsyncWriter)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_async_writer.csv").string();
+    auto row_num = miocsv::BaseWriter::BUFFER_SIZE / 4;
+    {
+        auto writer = miocsv::AsyncWriter {path};
+        writer.write_row({"id", "name, quoted", "value"});
+        for (miocsv::size_type i = 0; i != row_num; ++i)
+            writer.write_row_raw(i, "link", i * 0.5);
+
+        // all the rows so far are in the file after flush()
+        writer.flush();
+        miocsv::size_type n = 0;
+        for ([[maybe_unused]] const auto& line : miocsv::Reader {path})
+            ++n;
+
+        EXPECT_EQ(n, row_num + 1);
+
+        writer.write_row_raw("last", -1, 0.25);
+        writer.close();
+        writer.close();
+    }
+
+    auto reader = miocsv::Reader {path};
+    miocsv::size_type i = 0;
+    std::string last;
+    for (const auto& line : reader)
+    {
+        if (i == 0)
+            EXPECT_EQ(line[1], "\"name, quoted\"");
+        else if (i <= row_num)
+            ASSERT_EQ(line[0], std::to_string(i - 1));
+        else
+            last = line[0];
+
+        ++i;
+    }
+
+    EXPECT_EQ(i, row_num + 2);
+    EXPECT_EQ(last, "last");
+    std::filesystem::remove(path);
+
+    // the failure of the I/O thread is rethrown on the calling thread
+    auto writer = miocsv::AsyncWriter {"/dev/full"};
+    writer.write_row_raw("no", "space", "left");
+    ASSERT_THROW(writer.flush(), std::runtime_error);
+    ASSERT_THROW(writer.close(), std::runtime_error);
+}
+
+TEST(MIOCSVTest, MMapWriter)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_mmap_writer.csv").string();
+    {
+        auto writer = miocsv::MMapWriter {path};
+        writer.write_row({"id", "name, quoted", "value"});
+        writer.write_row_raw(1, "link", 0.5);
+    }
+
+    EXPECT_EQ(std::filesystem::file_size(path), 35);
+    auto reader = miocsv::Reader {path};
+    auto it = reader.begin();
+    EXPECT_EQ((*it)[1], "\"name, quoted\"");
+    ++it;
+    EXPECT_EQ((*it)[2], "0.5");
+
+    // span more than one segment
+    std::string s(1023, 'x');
+    miocsv::size_type row_num = miocsv::MMapWriter::SEGMENT_SIZE / 1024 + 100;
+    {
+        auto writer = miocsv::MMapWriter {path};
+        for (miocsv::size_type i = 0; i != row_num; ++i)
+        {
+            s[0] = static_cast<char>('a' + i % 26);
+            writer.write_row_raw(s);
+        }
+
+        writer.close();
+        EXPECT_EQ(writer.get_size(), row_num * 1024);
+    }
+
+    ASSERT_EQ(std::filesystem::file_size(path), row_num * 1024);
+    miocsv::size_type i = 0;
+    for (const auto& line : miocsv::MIOReader {path})
+    {
+        ASSERT_EQ(line[0].size(), 1023);
+        ASSERT_EQ(line[0][0], 'a' + i % 26);
+        ++i;
+    }
+
+    EXPECT_EQ(i, row_num);
+
+    // nothing can be written after close(), which leaves the file as it is
+    {
+        auto writer = miocsv::MMapWriter {path};
+        writer.write_row_raw("closed");
+        writer.close();
+        writer.write_row_raw("late");
+        ASSERT_THROW(writer.flush(), std::runtime_error);
+        writer.close();
+    }
+
+    EXPECT_EQ(std::filesystem::file_size(path), 7);
+    std::filesystem::remove(path);
+
+    // a failure on closing is reported rather than terminating
+    auto writer = miocsv::MMapWriter {path};
+    writer.write_row_raw("gone");
+    std::filesystem::remove(path);
+    ASSERT_THROW(writer.close(), std::runtime_error);
+    EXPECT_FALSE(std::filesystem::exists(path));
+}
+
+TEST(MIOCSVTest, WriteRowsParallel)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_parallel.csv").string();
+    auto serial_path = (std::filesystem::temp_directory_path() / "miocsv_serial.csv").string();
+    auto read_all = [](const std::string& p) {
+        std::ifstream ist {p, std::ios::binary};
+        return std::string {std::istreambuf_iterator<char>{ist}, std::istreambuf_iterator<char>{}};
+    };
+
+    std::vector<miocsv::size_type> ids(300000);
+    std::iota(ids.begin(), ids.end(), 0);
+    auto fn = [](miocsv::BaseWriter& w, miocsv::size_type i) {
+        if (i % 1000)
+            w.write_row_raw(i, "link", i * 0.1);
+        else
+            w.write_row({std::to_string(i), "quoted, \"link\"", "0"});
+    };
+
+    {
+        auto writer = miocsv::Writer {serial_path};
+        for (auto i : ids)
+            fn(writer, i);
+    }
+
+    auto expected = read_all(serial_path);
+    for (miocsv::size_type thread_num : {1, 2, 3})
+    {
+        miocsv::write_rows_parallel(path, ids, fn, thread_num);
+        ASSERT_EQ(read_all(path), expected);
+    }
+
+    miocsv::write_rows_parallel(path, std::vector<int>{}, [](miocsv::BaseWriter& w, int i) { w.append(i); });
+    EXPECT_EQ(std::filesystem::file_size(path), 0);
+
+    std::filesystem::remove(path);
+    std::filesystem::remove(serial_path);
+}
+
+TEST(MIOCSVTest, ConcurrentWriter)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_concurrent.csv").string();
+    constexpr miocsv::size_type THREAD_NUM = 4;
+    constexpr miocsv::size_type ROW_NUM = 50000;
+    {
+        auto writer = miocsv::ConcurrentWriter {path};
+        std::vector<std::thread> producers;
+        for (miocsv::size_type k = 0; k != THREAD_NUM; ++k)
+        {
+            producers.emplace_back([&writer, k]() {
+                for (miocsv::size_type i = 0; i != ROW_NUM; ++i)
+                {
+                    if (i % 100)
+                        writer.write_row_raw(k, i, "a record long enough to fill buffers", i * 0.5);
+                    else
+                        writer.write_row({std::to_string(k), std::to_string(i), "quoted, \"record\"", "0"});
+                }
+
+                // the rows of this thread so far are all written out
+                if (k == 0)
+                    writer.flush();
+            });
+        }
+
+        for (auto& p : producers)
+            p.join();
+    }
+
+    // whole rows only and in order per thread
+    std::vector<miocsv::size_type> next(THREAD_NUM, 0);
+    for (const auto& line : miocsv::Reader {path})
+    {
+        ASSERT_EQ(line.size(), 4);
+        auto k = std::stoul(line[0]);
+        ASSERT_LT(k, THREAD_NUM);
+        ASSERT_EQ(line[1], std::to_string(next[k]++));
+    }
+
+    for (auto n : next)
+        EXPECT_EQ(n, ROW_NUM);
+
+    std::filesystem::remove(path);
+
+    auto writer = miocsv::ConcurrentWriter {"/dev/full"};
+    writer.write_row_raw("no", "space", "left");
+    ASSERT_THROW(writer.flush(), std::runtime_error);
+    ASSERT_THROW(writer.close(), std::runtime_error);
+}
+
+TEST(MIOCSVTest, MultiFileReaders)
+{
+    auto paths = split_file(TEST_FILE, 4, false);
+    ASSERT_EQ(miocsv::glob(std::filesystem::path{paths[0]}.parent_path().string() + "/part-?.csv"),
+              paths);
+
+    auto reader = miocsv::MultiFileReader {paths};
+    validate_parsed_content(&reader);
+    ASSERT_EQ(reader.get_row_num(), 2951);
+    ASSERT_EQ(reader.get_file_index(), 3);
+
+    paths = split_file(TEST_FILE, 4, true);
+    auto dict_reader = miocsv::MultiFileDictReader {paths};
+    validate_parsed_content(&dict_reader);
+    ASSERT_EQ(dict_reader.get_row_num(), 2951);
+
+    // rows are delivered out of order but with the same global row numbers
+    std::vector<std::string> lines(2952);
+    std::mutex mtx;
+    dict_reader.parallel_for_each([&](const miocsv::Row& line, miocsv::size_type row_num) {
+        std::ostringstream os;
+        os << line << ',' << line["link_id"];
+
+        std::lock_guard<std::mutex> lk {mtx};
+        ASSERT_LE(row_num, 2951);
+        ASSERT_TRUE(lines[row_num].empty());
+        lines[row_num] = os.str();
+    }, 3);
+
+    auto mioreader = miocsv::MIODictReader {TEST_FILE};
+    for (const auto& line : mioreader)
+    {
+        std::ostringstream os;
+        os << line << ',' << line["link_id"];
+        ASSERT_EQ(lines[mioreader.get_row_num()], os.str());
+    }
+
+    // an empty file in the middle is skipped
+    miocsv::size_type part_num = 0;
+    for (const auto& line : miocsv::MIODictReader {paths[1]})
+        part_num += !line.empty();
+
+    std::ofstream {paths[1], std::ios::trunc};
+    auto skipped = miocsv::MultiFileDictReader {paths};
+    miocsv::size_type n = 0;
+    std::vector<miocsv::size_type> files;
+    for (const auto& line : skipped)
+    {
+        ASSERT_EQ(line.size(), 22);
+        files.push_back(skipped.get_file_index());
+        ++n;
+    }
+
+    EXPECT_EQ(n, 2950 - part_num);
+    EXPECT_EQ(files.back(), 3);
+    EXPECT_EQ(std::count(files.begin(), files.end(), 1), 0);
+
+    std::atomic<miocsv::size_type> m {0};
+    skipped.parallel_for_each([&m](const miocsv::Row&, miocsv::size_type) { ++m; }, 3);
+    EXPECT_EQ(m, n);
+}
+
+TEST(MIOCSVTest, BatchReaders)
+{
+    auto paths = split_file(TEST_FILE, 50, true);
+
+    // a zero threshold maps every file while the default one reads every file
+    for (miocsv::size_type threshold : {0, 1 << 16})
+    {
+        auto reader = miocsv::BatchReader {',', threshold};
+        auto dict_reader = miocsv::BatchDictReader {{}, ',', threshold};
+
+        miocsv::size_type row_num = 0, dict_row_num = 0;
+        for (const auto& path : paths)
+        {
+            ASSERT_TRUE(reader.open(path));
+            for ([[maybe_unused]] const auto& line : reader)
+                ++row_num;
+
+            ASSERT_TRUE(dict_reader.open(path));
+            ASSERT_EQ(dict_reader.get_fieldnames().size(), PARSED_HEADERS.size());
+            for (const auto& line : dict_reader)
+            {
+                compare(line);
+                ++dict_row_num;
+            }
+        }
+
+        ASSERT_EQ(row_num, 2950 + paths.size());
+        ASSERT_EQ(dict_row_num, 2950);
+        ASSERT_FALSE(reader.open("mock.csv"));
+        ASSERT_FALSE(dict_reader.open("mock.csv"));
+    }
+
+    auto reader = miocsv::BatchReader {};
+    ASSERT_TRUE(reader.open(TEST_FILE));
+    validate_parsed_content(&reader);
+
+    auto dict_reader = miocsv::BatchDictReader {};
+    ASSERT_TRUE(dict_reader.open(TEST_FILE));
+    validate_parsed_content(&dict_reader);
+
+    // leading blank lines are skipped before the headers, whether they are reused or not
+    auto dir = std::filesystem::temp_directory_path();
+    std::vector<std::pair<std::string, std::string>> files {
+        {"blank-0.csv", "\n\nh1,h2\n1,2\n"}, {"blank-1.csv", "h1,h2\n3,4\n"}, {"blank-2.csv", "\nh1,h2\n5,6\n"},
+        {"blank-3.csv", "\r\nh1,h2\r\n7,8\r\n"}};
+
+    auto blank_reader = miocsv::BatchDictReader {};
+    for (miocsv::size_type i = 0; i != files.size(); ++i)
+    {
+        auto path = (dir / files[i].first).string();
+        std::ofstream {path, std::ios::binary} << files[i].second;
+
+        ASSERT_TRUE(blank_reader.open(path));
+        ASSERT_EQ(blank_reader.get_fieldnames().size(), 2);
+        miocsv::size_type n = 0;
+        for (const auto& line : blank_reader)
+        {
+            EXPECT_EQ(line["h1"], std::to_string(2 * i + 1));
+            EXPECT_EQ(line["h2"], std::to_string(2 * i + 2));
+            ++n;
+        }
+
+        EXPECT_EQ(n, 1);
+        std::filesystem::remove(path);
+    }
+}
+
+TEST(MIOCSVTest, BufferReaders)
+{
+    std::ifstream ist {TEST_FILE, std::ios::binary};
+    std::string s {std::istreambuf_iterator<char>{ist}, std::istreambuf_iterator<char>{}};
+
+    auto reader = miocsv::BufferReader {s};
+    validate_parsed_content(&reader);
+    ASSERT_EQ(reader.get_row_num(), 2951);
+
+    auto dict_reader = miocsv::BufferDictReader {s};
+    validate_parsed_content(&dict_reader);
+    ASSERT_EQ(dict_reader.get_row_num(), 2951);
+
+    // the last line is not terminated and nothing beyond the buffer is touched
+    std::vector<char> buf {'a', ',', '"', 'b', '"', '\n', 'c', ',', 'd', '\r'};
+    auto buf_reader = miocsv::BufferReader {std::string_view{buf.data(), buf.size()}};
+    std::vector<std::vector<std::string>> rows;
+    for (const auto& line : buf_reader)
+        rows.emplace_back(line.begin(), line.end());
+
+    ASSERT_EQ(rows.size(), 2);
+    compare(miocsv::Row{"a", "\"b\""}, rows[0]);
+    compare(miocsv::Row{"c", "d"}, rows[1]);
+}
+
+TEST(MIOCSVTest, FollowReaders)
+{
+    using namespace std::chrono_literals;
+
+    std::ifstream ist {TEST_FILE, std::ios::binary};
+    std::string s {std::istreambuf_iterator<char>{ist}, std::istreambuf_iterator<char>{}};
+    // drop the last '\n', which shall not lose the last row
+    s.pop_back();
+
+    auto path = std::filesystem::temp_directory_path() / "miocsv_follow.csv";
+    std::filesystem::remove(path);
+
+    // append the file in uneven pieces, which mostly end in the middle of a line
+    std::thread simulator {[&]() {
+        for (miocsv::size_type i = 0, n = 0; i < s.size(); i += n, n = n * 2 + 7)
+        {
+            std::ofstream ost {path, std::ios::binary | std::ios::app};
+            ost << s.substr(i, std::min(n, s.size() - i));
+            ost.close();
+            std::this_thread::sleep_for(1ms);
+        }
+    }};
+
+    auto reader = miocsv::FollowDictReader {path.string(), {}, ',', 1ms, 300ms};
+    validate_parsed_content(&reader);
+    ASSERT_EQ(reader.get_row_num(), 2951);
+    ASSERT_EQ(reader.get_offset(), s.size());
+    simulator.join();
+
+    // it waits for rows until stop() is called
+    auto follower = miocsv::FollowReader {path.string(), ',', 1ms};
+    std::thread stopper {[&]() {
+        std::this_thread::sleep_for(50ms);
+        follower.stop();
+    }};
+
+    miocsv::size_type row_num = 0;
+    for ([[maybe_unused]] const auto& line : follower)
+        ++row_num;
+
+    stopper.join();
+    // the last line is held back as it is not terminated
+    ASSERT_EQ(row_num, 2950);
+    ASSERT_EQ(follower.get_offset(), s.rfind('\n') + 1);
+
+    // the partial line is still delivered when the timeout hits in the poll with complete lines
+    std::ofstream {path, std::ios::binary | std::ios::trunc} << "1,2\n3,4";
+    auto expiring = miocsv::FollowReader {path.string(), ',', 1ms, 1ms};
+    std::vector<miocsv::Row> rows;
+    for (const auto& line : expiring)
+        rows.emplace_back(line);
+
+    ASSERT_EQ(rows.size(), 2);
+    compare(rows[1], {"3", "4"});
+    ASSERT_EQ(expiring.get_offset(), 7);
+}
+
+#ifdef BGZF_TEST_FILE
+TEST(MIOCSVTest, BGZFReaders)
+{
+    // test.csv.gz is made of 4KB blocks so that rows straddle blocks and windows
+    for (miocsv::size_type thread_num : {1, 3, 8})
+    {
+        auto reader = miocsv::BGZFReader {BGZF_TEST_FILE, ',', thread_num};
+        validate_parsed_content(&reader);
+        ASSERT_EQ(reader.get_row_num(), 2951);
+
+        auto dict_reader = miocsv::BGZFDictReader {BGZF_TEST_FILE, {}, ',', thread_num};
+        validate_parsed_content(&dict_reader);
+        ASSERT_EQ(dict_reader.get_row_num(), 2951);
+    }
+
+    // every row shall be identical to the one from the uncompressed file
+    auto reader = miocsv::BGZFReader {BGZF_TEST_FILE, ',', 2};
+    auto mioreader = miocsv::MIOReader {TEST_FILE};
+    auto it = reader.begin();
+    for (const auto& line : mioreader)
+    {
+        ASSERT_NE(it, reader.end());
+        compare(*it, {line.begin(), line.end()});
+        ++it;
+    }
+    ASSERT_EQ(it, reader.end());
+}
+
+TEST(MIOCSVTest, BGZFWriter)
+{
+    auto path = (std::filesystem::temp_directory_path() / "miocsv_writer.csv.gz").string();
+    auto row_num = miocsv::BaseWriter::BUFFER_SIZE / 8;
+    std::string incompressible;
+    std::mt19937 gen {0};
+    while (incompressible.size() != 100000)
+    {
+        auto c = static_cast<char>(gen());
+        if (c != ',' && c != '"' && c != '\r' && c != '\n')
+            incompressible.push_back(c);
+    }
+
+    for (miocsv::size_type thread_num : {1, 3})
+    {
+        {
+            auto writer = miocsv::BGZFWriter {path, ',', thread_num};
+            writer.write_row({"id", "name, quoted", "value"});
+            for (miocsv::size_type i = 0; i != row_num; ++i)
+                writer.write_row_raw(i, "link", i * 0.5);
+
+            // more than a block of random bytes
+            writer.write_row_raw(incompressible);
+        }
+
+        // a standard gzip stream
+        auto* gz = gzopen(path.c_str(), "rb");
+        ASSERT_NE(gz, nullptr);
+        std::string s;
+        char chars[4096];
+        for (int n; (n = gzread(gz, chars, sizeof(chars))) > 0;)
+            s.append(chars, n);
+
+        gzclose(gz);
+        EXPECT_EQ(s.substr(0, 24), "id,\"name, quoted\",value\n");
+        EXPECT_EQ(s.substr(s.size() - incompressible.size() - 1), incompressible + '\n');
+
+        // and BGZF
+        auto reader = miocsv::BGZFReader {path, ',', 2};
+        miocsv::size_type i = 0;
+        for (const auto& line : reader)
+        {
+            if (i && i <= row_num)
+            {
+                ASSERT_EQ(line[0], std::to_string(i - 1));
+            }
+
+            ++i;
+        }
+
+        EXPECT_EQ(i, row_num + 2);
+    }
+
+    // flush() waits until the buffered output is written out
+    {
+        auto writer = miocsv::BGZFWriter {path, ',', 2};
+        writer.write_row_raw("flushed");
+        writer.flush();
+        EXPECT_GT(std::filesystem::file_size(path), 0);
+    }
+
+    std::filesystem::remove(path);
+
+    // the failure of a worker is rethrown by the next hand-over
+    auto writer = miocsv::BGZFWriter {"/dev/full", ',', 2};
+    auto write = [&]() {
+        for (miocsv::size_type i = 0; i != row_num * 2; ++i)
+            writer.write_row_raw(i, "link", i * 0.5);
+    };
+
+    ASSERT_THROW(write(), std::runtime_error);
+    ASSERT_THROW(writer.close(), std::runtime_error);
+}
+
+TEST(MIOCSVTest, BGZFNotCompressed)
+{
+    ASSERT_DEATH(miocsv::BGZFReader{TEST_FILE}, "is not BGZF-compressed");
+}
+#endif
+
 } // namespace